@@ -0,0 +1,38 @@
+#ifndef BENCH_CICLOS_H
+#define BENCH_CICLOS_H
+
+#include <stdint.h>
+#include "hardware/structs/systick.h"
+
+// Medição com o SysTick (contador decrescente de 24 bits no clock da CPU)
+
+#define REPETICOES 16
+
+static inline void systick_iniciar(void) {
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Habilitado, fonte = clock do processador
+}
+
+static inline uint32_t systick_ler(void) {
+    return systick_hw->cvr;
+}
+
+static inline uint32_t ciclos_desde(uint32_t inicio) {
+    return (inicio - systick_ler()) & 0x00FFFFFF;
+}
+
+// Menor contagem de ciclos entre REPETICOES execuções de expr
+#define MEDIR(resultado, expr)                                  \
+    do {                                                        \
+        uint32_t menor = UINT32_MAX;                            \
+        for (int r = 0; r < REPETICOES; ++r) {                  \
+            uint32_t t0 = systick_ler();                        \
+            expr;                                               \
+            uint32_t c = ciclos_desde(t0);                      \
+            if (c < menor) menor = c;                           \
+        }                                                       \
+        (resultado) = menor;                                    \
+    } while (0)
+
+#endif
@@ -0,0 +1,81 @@
+// Comparação de ciclos entre as primitivas de desenho por pixel (versão
+// anterior da biblioteca) e as primitivas que operam direto nos bytes de
+// página. Nada é enviado ao display: mede-se apenas a rasterização.
+//
+// Saída em CSV pela stdio: primitiva,ciclos_por_pixel_a_pixel,ciclos_raster
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "lib/ssd1306.h"
+#include "bench/bench_ciclos.h"
+
+// --- Implementações de referência (uma chamada de ssd1306_pixel por ponto) ---
+
+static void ref_fill(ssd1306_t *ssd, bool value) {
+    for (uint8_t y = 0; y < ssd->height; ++y)
+        for (uint8_t x = 0; x < ssd->width; ++x)
+            ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+    for (uint8_t x = left; x < left + width; ++x) {
+        ssd1306_pixel(ssd, x, top, value);
+        ssd1306_pixel(ssd, x, top + height - 1, value);
+    }
+    for (uint8_t y = top; y < top + height; ++y) {
+        ssd1306_pixel(ssd, left, y, value);
+        ssd1306_pixel(ssd, left + width - 1, y, value);
+    }
+    if (fill)
+        for (uint8_t x = left + 1; x < left + width - 1; ++x)
+            for (uint8_t y = top + 1; y < top + height - 1; ++y)
+                ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+    for (uint8_t x = x0; x <= x1; ++x)
+        ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+    for (uint8_t y = y0; y <= y1; ++y)
+        ssd1306_pixel(ssd, x, y, value);
+}
+
+static void relatar(const char *nome, uint32_t antes, uint32_t depois) {
+    printf("%s,%lu,%lu\n", nome, (unsigned long)antes, (unsigned long)depois);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000); // Tempo para o terminal USB conectar
+
+    ssd1306_t ssd;
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, i2c1);
+    systick_iniciar();
+
+    uint32_t antes, depois;
+    printf("primitiva,ciclos_pixel_a_pixel,ciclos_raster\n");
+
+    MEDIR(antes, ref_fill(&ssd, false));
+    MEDIR(depois, ssd1306_fill(&ssd, false));
+    relatar("fill", antes, depois);
+
+    MEDIR(antes, ref_rect(&ssd, 0, 0, 128, 64, true, false));
+    MEDIR(depois, ssd1306_rect(&ssd, 0, 0, 128, 64, true, false));
+    relatar("rect_borda", antes, depois);
+
+    MEDIR(antes, ref_rect(&ssd, 5, 10, 100, 50, true, true));
+    MEDIR(depois, ssd1306_rect(&ssd, 5, 10, 100, 50, true, true));
+    relatar("rect_cheio", antes, depois);
+
+    MEDIR(antes, ref_hline(&ssd, 0, 127, 16, true));
+    MEDIR(depois, ssd1306_hline(&ssd, 0, 127, 16, true));
+    relatar("hline", antes, depois);
+
+    MEDIR(antes, ref_vline(&ssd, 55, 16, 63, true));
+    MEDIR(depois, ssd1306_vline(&ssd, 55, 16, 63, true));
+    relatar("vline", antes, depois);
+
+    while (true)
+        tight_loop_contents();
+}
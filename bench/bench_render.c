@@ -0,0 +1,148 @@
+// Tempo e tráfego I2C por quadro das primitivas de desenho e das telas
+// completas. Cada caso alterna entre dois conteúdos, de modo que todo quadro
+// tem algo a enviar; a DMA termina fora da medição. A exceção é
+// tela_treino_estavel, o quadro sem mudanças (custo do modo retido).
+//
+// Saída em CSV pela stdio, uma linha por caso:
+//   caso,ns_desenho,ns_quadro,bytes_i2c
+// ns_desenho mede só o framebuffer, ns_quadro inclui o ssd1306_flush() (ou o
+// disparo da DMA); os tempos são o mínimo de REPETICOES_QUADRO quadros e
+// bytes_i2c é a média por quadro (controle + comandos + dados).
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "lib/ssd1306.h"
+#include "lib/telas.h"
+#include "bench/bench_tempo.h"
+
+#define REPETICOES_QUADRO 32
+
+#define I2C_PORT i2c1
+#define I2C_SDA 14
+#define I2C_SCL 15
+#define OLED_ADDRESS 0x3C
+
+static ssd1306_t ssd;
+static widget_state_t estado;
+
+typedef void (*desenho_t)(int quadro);
+
+static void medir(const char *caso, desenho_t desenhar, bool assincrono) {
+    uint32_t menor_desenho = UINT32_MAX;
+    uint32_t menor_quadro = UINT32_MAX;
+
+    // Quadro de aquecimento: deixa o painel no estado da alternância
+    desenhar(REPETICOES_QUADRO - 1);
+    ssd1306_flush(&ssd);
+    uint32_t bytes_inicio = ssd.tx_bytes;
+
+    for (int quadro = 0; quadro < REPETICOES_QUADRO; ++quadro) {
+        bench_marca_t t0 = bench_marca();
+        desenhar(quadro);
+        uint32_t desenho = bench_ns_desde(t0);
+        if (assincrono)
+            ssd1306_flush_async(&ssd);
+        else
+            ssd1306_flush(&ssd);
+        uint32_t total = bench_ns_desde(t0);
+        ssd1306_wait(&ssd);
+
+        if (desenho < menor_desenho) menor_desenho = desenho;
+        if (total < menor_quadro) menor_quadro = total;
+    }
+
+    printf("%s,%lu,%lu,%lu\n", caso, (unsigned long)menor_desenho, (unsigned long)menor_quadro,
+           (unsigned long)((ssd.tx_bytes - bytes_inicio) / REPETICOES_QUADRO));
+}
+
+// --- Primitivas ---
+
+static void caso_fill(int quadro) {
+    ssd1306_fill(&ssd, quadro & 1);
+}
+
+static void caso_draw_string(int quadro) {
+    ssd1306_draw_string(&ssd, (quadro & 1) ? "Vel.: 12.5 Km/h" : "Vel.: 13.0 Km/h", 0, 20);
+}
+
+static void caso_line(int quadro) {
+    ssd1306_line(&ssd, 0, 0, 127, 63, quadro & 1);
+}
+
+static void caso_rect(int quadro) {
+    ssd1306_rect(&ssd, 0, 0, 128, 64, quadro & 1, false);
+}
+
+// --- Telas completas ---
+
+static telemetria_t fotografia(tela_t tela, int quadro) {
+    telemetria_t t = {
+        .tick = (uint32_t)quadro,
+        .tela = tela,
+        .velocidade = 100 + (quadro & 1) * 5,
+        .inclinacao = 60,
+        .distancia_mm = 1234567 + (uint32_t)quadro * 1389,
+        .velocidade_media = 97 + (quadro & 1),
+        .inclinacao_media = 58,
+        .tempo_decorrido_s = 1800 + quadro,
+    };
+    return t;
+}
+
+static void caso_tela_treino(int quadro) {
+    telemetria_t t = fotografia(TELA_TREINO, quadro);
+    desenhar_tela(&ssd, &estado, &t);
+}
+
+static void caso_tela_treino_estavel(int quadro) {
+    (void)quadro;
+    telemetria_t t = fotografia(TELA_TREINO, 0);
+    desenhar_tela(&ssd, &estado, &t);
+}
+
+static void caso_tela_medias(int quadro) {
+    telemetria_t t = fotografia(TELA_MEDIAS, quadro);
+    desenhar_tela(&ssd, &estado, &t);
+}
+
+static void caso_quadro_cheio(int quadro) {
+    ssd1306_fill(&ssd, quadro & 1);
+    ssd.panel_synced = false; // Força o envio do quadro inteiro
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000); // Tempo para o terminal USB conectar
+
+    i2c_init(I2C_PORT, 400 * 1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, OLED_ADDRESS, I2C_PORT);
+    ssd1306_config(&ssd);
+    ssd1306_fill(&ssd, false);
+    ssd1306_send_data(&ssd);
+    ssd1306_dma_init(&ssd);
+    bench_tempo_iniciar();
+
+    printf("caso,ns_desenho,ns_quadro,bytes_i2c\n");
+    medir("fill", caso_fill, false);
+    medir("draw_string", caso_draw_string, false);
+    medir("line", caso_line, false);
+    medir("rect", caso_rect, false);
+    // As primitivas mexeram no framebuffer por fora das telas
+    widget_invalidate(&estado);
+    medir("tela_treino", caso_tela_treino, true);
+    medir("tela_treino_estavel", caso_tela_treino_estavel, true);
+    medir("tela_medias", caso_tela_medias, false);
+    medir("quadro_cheio", caso_quadro_cheio, false);
+
+#ifdef EMBARCATECH_HOST
+    return 0;
+#else
+    while (true)
+        tight_loop_contents();
+#endif
+}
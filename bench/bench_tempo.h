@@ -0,0 +1,49 @@
+#ifndef BENCH_TEMPO_H
+#define BENCH_TEMPO_H
+
+#include <stdint.h>
+
+// Relógio dos benchmarks em nanossegundos: SysTick (ciclos da CPU) na placa e
+// CLOCK_MONOTONIC no build para Linux. Intervalos de até ~130 ms a 125 MHz.
+
+#ifdef EMBARCATECH_HOST
+
+#include <time.h>
+
+typedef uint64_t bench_marca_t;
+
+static inline void bench_tempo_iniciar(void) {
+}
+
+static inline bench_marca_t bench_marca(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint32_t bench_ns_desde(bench_marca_t inicio) {
+    return (uint32_t)(bench_marca() - inicio);
+}
+
+#else
+
+#include "hardware/clocks.h"
+#include "bench/bench_ciclos.h"
+
+typedef uint32_t bench_marca_t;
+
+static inline void bench_tempo_iniciar(void) {
+    systick_iniciar();
+}
+
+static inline bench_marca_t bench_marca(void) {
+    return systick_ler();
+}
+
+static inline uint32_t bench_ns_desde(bench_marca_t inicio) {
+    return (uint32_t)((uint64_t)ciclos_desde(inicio) * 1000000000u / clock_get_hz(clk_sys));
+}
+
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+// Comparação de ciclos por tick entre a aritmética do treino em float
+// (versão anterior, emulada em software no Cortex-M0+) e a versão em
+// ponto fixo de lib/treino.c. O tempo é simulado com passos de 500 ms.
+//
+// Saída em CSV pela stdio: cenario,ciclos_float,ciclos_ponto_fixo
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "lib/treino.h"
+#include "bench/bench_ciclos.h"
+
+#define PASSO_US 500000u
+
+// --- Implementação de referência (cópia do tick em float) ---
+
+static const float ref_inclinacao_niveis[] = {0.0, 3.0, 6.0, 9.0, 12.0};
+
+typedef struct {
+    float velocidade;
+    float inclinacao;
+    float distancia;
+    float soma_velocidade;
+    float soma_inclinacao;
+    int contador_medidas;
+    int indice_inclinacao;
+    uint64_t anterior_us;
+} ref_treino_t;
+
+static void ref_tick(ref_treino_t *t, uint16_t valor_x, uint16_t valor_y, uint64_t agora_us) {
+    if (valor_y > 3000 && t->indice_inclinacao < 4) {
+        t->indice_inclinacao++;
+    } else if (valor_y < 1000 && t->indice_inclinacao > 0) {
+        t->indice_inclinacao--;
+    }
+    t->inclinacao = ref_inclinacao_niveis[t->indice_inclinacao];
+
+    if (valor_x > 3000 && t->velocidade < 14) {
+        t->velocidade += 0.5;
+    } else if (valor_x < 1000 && t->velocidade > 0.0) {
+        t->velocidade -= 0.5;
+    }
+
+    t->soma_velocidade += t->velocidade;
+    t->soma_inclinacao += t->inclinacao;
+    t->contador_medidas++;
+
+    int64_t tempo_decorrido_ms = (int64_t)(agora_us - t->anterior_us) / 1000;
+    t->anterior_us = agora_us;
+
+    t->distancia += (t->velocidade * 1000 / 3600) * (tempo_decorrido_ms / 1000.0);
+}
+
+static void relatar(const char *nome, uint32_t antes, uint32_t depois) {
+    printf("%s,%lu,%lu\n", nome, (unsigned long)antes, (unsigned long)depois);
+}
+
+// Entradas voláteis para o compilador não dobrar as constantes
+static volatile uint16_t eixo_x, eixo_y;
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000); // Tempo para o terminal USB conectar
+
+    systick_iniciar();
+
+    ref_treino_t ref = { 0 };
+    treino_t treino;
+    treino_reiniciar(&treino, 0);
+    uint64_t agora_ref = 0, agora = 0;
+
+    uint32_t antes, depois;
+    printf("cenario,ciclos_float,ciclos_ponto_fixo\n");
+
+    // Joystick centrado: só integração de distância e somas
+    eixo_x = 2048;
+    eixo_y = 2048;
+    ref.velocidade = 10.0;
+    treino.velocidade = 100;
+    MEDIR(antes, (agora_ref += PASSO_US, ref_tick(&ref, eixo_x, eixo_y, agora_ref)));
+    MEDIR(depois, (agora += PASSO_US, treino_tick(&treino, eixo_x, eixo_y, agora)));
+    relatar("tick_centro", antes, depois);
+
+    // Joystick para cima e para a direita: ajusta velocidade e inclinação
+    eixo_x = 4000;
+    eixo_y = 4000;
+    ref.velocidade = 0.0;
+    treino.velocidade = 0;
+    MEDIR(antes, (agora_ref += PASSO_US, ref_tick(&ref, eixo_x, eixo_y, agora_ref)));
+    MEDIR(depois, (agora += PASSO_US, treino_tick(&treino, eixo_x, eixo_y, agora)));
+    relatar("tick_ajuste", antes, depois);
+
+    // Médias exibidas ao pausar
+    volatile float media_ref;
+    volatile uint16_t media;
+    MEDIR(antes, media_ref = ref.soma_velocidade / ref.contador_medidas);
+    MEDIR(depois, media = treino_velocidade_media(&treino));
+    relatar("media", antes, depois);
+    (void)media_ref;
+    (void)media;
+
+    while (true)
+        tight_loop_contents();
+}
@@ -0,0 +1,17 @@
+#ifndef _HARDWARE_FLASH_H
+#define _HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_BLOCK_SIZE (1u << 16)
+
+// Flash da Pico W
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+// Mesma semântica da NOR: apagar deixa 0xFF e gravar só leva bits a 0
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef _HARDWARE_REGS_ADDRESSMAP_H
+#define _HARDWARE_REGS_ADDRESSMAP_H
+
+#include <stdint.h>
+
+// A flash mapeada pela XIP é memória do simulador (host/perifericos.c),
+// compartilhada entre os reinícios pelo watchdog
+extern uint8_t *sim_flash_memory;
+#define XIP_BASE ((uintptr_t)sim_flash_memory)
+
+#endif
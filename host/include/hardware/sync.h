@@ -0,0 +1,27 @@
+#ifndef _HARDWARE_SYNC_H
+#define _HARDWARE_SYNC_H
+
+#include "pico.h"
+
+// As IRQs simuladas só são atendidas nos pontos de espera, então desabilitar
+// interrupções não precisa fazer nada.
+static inline uint32_t save_and_disable_interrupts(void) {
+  return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+  (void)status;
+}
+
+static inline void __dmb(void) {
+  __sync_synchronize();
+}
+
+static inline void __nop(void) {
+}
+
+void __sev(void);
+void __wfe(void);
+void __wfi(void);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef _HARDWARE_TIMER_H
+#define _HARDWARE_TIMER_H
+
+#include "pico.h"
+
+// Microssegundos do relógio virtual desde o "boot" da simulação
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+
+void busy_wait_us(uint64_t delay_us);
+void busy_wait_ms(uint32_t delay_ms);
+
+#endif
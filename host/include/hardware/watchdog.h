@@ -0,0 +1,14 @@
+#ifndef _HARDWARE_WATCHDOG_H
+#define _HARDWARE_WATCHDOG_H
+
+#include "pico.h"
+
+// O prazo corre no relógio virtual; vencido, o simulador reinicia o firmware
+// num processo novo, com a RAM retida e a flash de antes (host/sim.c)
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+void watchdog_disable(void);
+bool watchdog_caused_reboot(void);
+bool watchdog_enable_caused_reboot(void);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _PICO_H
+#define _PICO_H
+
+// Shim do SDK do Pico para o build em Linux (host/). Só declara o que o
+// firmware e lib/ usam; o comportamento fica em host/*.c sobre um relógio
+// virtual.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+#define __not_in_flash(group)
+
+// RAM que o boot não zera: no host, uma seção que o simulador guarda e
+// devolve ao reiniciar pelo watchdog
+#define __uninitialized_ram(group) __attribute__((section("sim_retida"))) group
+
+#define __compiler_memory_barrier() __asm__ volatile("" ::: "memory")
+
+// Núcleo que está executando (0 ou 1)
+uint get_core_num(void);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef _PICO_MULTICORE_H
+#define _PICO_MULTICORE_H
+
+#include "pico.h"
+
+// O núcleo 1 roda numa thread; os dois núcleos se revezam nos pontos de
+// espera (__wfe, sleep, best_effort_wfe_or_timeout), o que mantém a
+// simulação determinística.
+void multicore_launch_core1(void (*entry)(void));
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+#include <stdio.h>
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#define NUM_BANK0_GPIOS 30
+
+bool stdio_init_all(void);
+// Byte direto para a saída, sem tradução de '\n' (telemetria binária)
+int putchar_raw(int c);
+// Entrada vem das linhas "serial" do roteiro
+int getchar_timeout_us(uint32_t timeout_us);
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+
+// No host, cada volta de espera ativa custa 1 µs de tempo virtual
+void tight_loop_contents(void);
+
+#endif
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+
+// main() do firmware, renomeado na compilação para o host
+int embarcatech_main(void);
+
+// Duração do treino definida no firmware (1 minuto na placa)
+extern int tempo_treino_minutos;
+
+// Captura com o rastro a reproduzir no lugar das entradas (-r acelerado, -R em tempo real)
+extern const uint8_t *rastro_reproduzir;
+extern size_t tamanho_rastro_reproduzir;
+extern bool rastro_tempo_real;
+
+static bool carregar_rastro(const char *caminho) {
+  FILE *f = fopen(caminho, "rb");
+  if (!f) {
+    perror(caminho);
+    return false;
+  }
+  size_t capacidade = 0, tamanho = 0;
+  uint8_t *dados = NULL;
+  size_t n;
+  do {
+    if (tamanho == capacidade) {
+      capacidade = capacidade ? capacidade * 2 : 65536;
+      dados = realloc(dados, capacidade);
+    }
+    n = fread(dados + tamanho, 1, capacidade - tamanho, f);
+    tamanho += n;
+  } while (n > 0);
+  fclose(f);
+  rastro_reproduzir = dados;
+  tamanho_rastro_reproduzir = tamanho;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *imagem_flash = NULL;
+  const char *rastro = NULL;
+  int opcao;
+  while ((opcao = getopt(argc, argv, "m:f:r:R:")) != -1) {
+    switch (opcao) {
+      case 'm':
+        tempo_treino_minutos = atoi(optarg);
+        break;
+      case 'f':
+        imagem_flash = optarg;
+        break;
+      case 'R':
+        rastro_tempo_real = true;
+        // fall through
+      case 'r':
+        rastro = optarg;
+        break;
+      default:
+        tempo_treino_minutos = 0;
+        break;
+    }
+  }
+  if (argc != optind + 1 || tempo_treino_minutos <= 0) {
+    fprintf(stderr, "uso: %s [-m minutos] [-f imagem_flash] [-r|-R captura] <roteiro>\n", argv[0]);
+    return 2;
+  }
+  if (!sim_flash_load(imagem_flash) || !sim_load_script(argv[optind]))
+    return 1;
+  if (rastro && !carregar_rastro(rastro))
+    return 1;
+  sim_boot();
+  return embarcatech_main();
+}
@@ -0,0 +1,927 @@
+#include "sim.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "pico/stdlib.h"
+#include "pico/util/queue.h"
+#include "pico/flash.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+// --- Clocks ---
+
+#define SIM_SYS_HZ_PADRAO 125000000u
+
+static uint32_t sys_hz = SIM_SYS_HZ_PADRAO;
+static uint32_t clock_changes;
+static uint64_t clock_changed_us;
+static uint64_t clock_reduced_us; // Tempo com clk_sys abaixo do padrão
+
+static void sim_set_sys_hz(uint32_t hz) {
+  uint64_t now = sim_now_us();
+  if (sys_hz < SIM_SYS_HZ_PADRAO)
+    clock_reduced_us += now - clock_changed_us;
+  clock_changed_us = now;
+  sys_hz = hz;
+  ++clock_changes;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+  (void)required;
+  sim_set_sys_hz(freq_khz * 1000);
+  return true;
+}
+
+void set_sys_clock_48mhz(void) {
+  sim_set_sys_hz(48000000);
+}
+
+void sim_clock_get_stats(uint32_t *changes, uint64_t *reduced_us) {
+  *changes = clock_changes;
+  *reduced_us = clock_reduced_us;
+  if (sys_hz < SIM_SYS_HZ_PADRAO)
+    *reduced_us += sim_now_us() - clock_changed_us;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+  switch (clk_index) {
+    case clk_sys:
+    case clk_peri:
+      return sys_hz;
+    case clk_ref:
+      return 12000000;
+    case clk_usb:
+    case clk_adc:
+      return 48000000;
+    case clk_rtc:
+      return 46875;
+    default:
+      return 125000000;
+  }
+}
+
+// --- GPIO ---
+
+typedef struct {
+  enum gpio_function function;
+  bool out;
+  bool out_value;
+  bool pull_up;
+  bool pull_down;
+  int driven;        // Nível aplicado pelo roteiro; < 0 quando solto
+  bool i2c_pin;      // Já foi SDA/SCL de uma porta I2C (continua ligado ao barramento como GPIO)
+  uint32_t irq_mask; // Eventos habilitados
+  uint32_t events;   // Eventos ocorridos e ainda não entregues
+} sim_gpio_t;
+
+static sim_gpio_t gpios[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t gpio_callback;
+static bool gpio_irq_installed;
+
+static bool sim_i2c_sda_held(uint port);
+static void sim_i2c_scl_rise(uint port);
+
+// No RP2040, o pino n é da porta I2C (n / 2) % 2: SDA nos pares, SCL nos ímpares
+static uint sim_gpio_i2c_port(uint gpio) {
+  return (gpio >> 1) & 1;
+}
+
+static bool sim_gpio_level(const sim_gpio_t *g) {
+  uint gpio = (uint)(g - gpios);
+  if (g->function == GPIO_FUNC_SIO && g->out)
+    return g->out_value;
+  if (g->i2c_pin && !(gpio & 1) && sim_i2c_sda_held(sim_gpio_i2c_port(gpio)))
+    return false; // Dreno aberto: o escravo preso ganha
+  if (g->driven >= 0)
+    return g->driven;
+  return g->pull_up && !g->pull_down;
+}
+
+static void sim_gpio_irq_handler(void) {
+  for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; ++gpio) {
+    uint32_t events = gpios[gpio].events & gpios[gpio].irq_mask;
+    gpios[gpio].events = 0;
+    if (events && gpio_callback)
+      gpio_callback(gpio, events);
+  }
+}
+
+// Registra a mudança de nível e levanta a IRQ do banco se houver borda habilitada
+static void sim_gpio_update(uint gpio, bool before) {
+  sim_gpio_t *g = &gpios[gpio];
+  bool after = sim_gpio_level(g);
+  if (after == before)
+    return;
+  if (g->i2c_pin && (gpio & 1) && after)
+    sim_i2c_scl_rise(sim_gpio_i2c_port(gpio));
+  g->events |= after ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+  if (g->events & g->irq_mask)
+    sim_irq_raise(IO_IRQ_BANK0);
+}
+
+void sim_gpio_drive(uint gpio, int level) {
+  bool before = sim_gpio_level(&gpios[gpio]);
+  gpios[gpio].driven = level;
+  sim_gpio_update(gpio, before);
+}
+
+void gpio_init(uint gpio) {
+  int driven = gpios[gpio].driven;
+  bool i2c_pin = gpios[gpio].i2c_pin;
+  memset(&gpios[gpio], 0, sizeof(sim_gpio_t));
+  gpios[gpio].function = GPIO_FUNC_SIO;
+  gpios[gpio].driven = driven;
+  gpios[gpio].i2c_pin = i2c_pin;
+}
+
+void gpio_deinit(uint gpio) {
+  gpio_set_function(gpio, GPIO_FUNC_NULL);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+  gpios[gpio].function = fn;
+  if (fn == GPIO_FUNC_I2C)
+    gpios[gpio].i2c_pin = true;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+  bool before = sim_gpio_level(&gpios[gpio]);
+  gpios[gpio].out = out;
+  sim_gpio_update(gpio, before);
+}
+
+void gpio_put(uint gpio, bool value) {
+  bool before = sim_gpio_level(&gpios[gpio]);
+  gpios[gpio].out_value = value;
+  sim_gpio_update(gpio, before);
+}
+
+bool gpio_get(uint gpio) {
+  return sim_gpio_level(&gpios[gpio]);
+}
+
+void gpio_set_pulls(uint gpio, bool up, bool down) {
+  bool before = sim_gpio_level(&gpios[gpio]);
+  gpios[gpio].pull_up = up;
+  gpios[gpio].pull_down = down;
+  sim_gpio_update(gpio, before);
+}
+
+void gpio_pull_up(uint gpio) {
+  gpio_set_pulls(gpio, true, false);
+}
+
+void gpio_pull_down(uint gpio) {
+  gpio_set_pulls(gpio, false, true);
+}
+
+void gpio_disable_pulls(uint gpio) {
+  gpio_set_pulls(gpio, false, false);
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+  if (enabled)
+    gpios[gpio].irq_mask |= event_mask;
+  else
+    gpios[gpio].irq_mask &= ~event_mask;
+  gpios[gpio].events &= ~event_mask;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+  gpio_set_irq_enabled(gpio, event_mask, enabled);
+  gpio_callback = callback;
+  if (!gpio_irq_installed) {
+    irq_set_exclusive_handler(IO_IRQ_BANK0, sim_gpio_irq_handler);
+    gpio_irq_installed = true;
+  }
+  if (enabled)
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void gpio_set_dormant_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+  gpio_set_irq_enabled(gpio, event_mask, enabled);
+}
+
+__attribute__((constructor)) static void sim_gpio_reset(void) {
+  for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; ++gpio) {
+    gpios[gpio].function = GPIO_FUNC_NULL;
+    gpios[gpio].driven = -1;
+  }
+}
+
+// --- PWM (só guarda a configuração) ---
+
+static struct {
+  uint16_t wrap;
+  float div;
+  bool enabled;
+  uint16_t level[2];
+} pwm_slices[8];
+
+pwm_config pwm_get_default_config(void) {
+  pwm_config c = { 0, 1 << 4, 0xffff };
+  return c;
+}
+
+void pwm_config_set_clkdiv(pwm_config *c, float div) {
+  c->div = (uint32_t)(div * 16.0f);
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap) {
+  c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) {
+  pwm_slices[slice_num].wrap = (uint16_t)c->top;
+  pwm_slices[slice_num].div = c->div / 16.0f;
+  pwm_slices[slice_num].enabled = start;
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+  pwm_slices[slice_num].wrap = wrap;
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+  pwm_slices[slice_num].div = divider;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+  pwm_slices[pwm_gpio_to_slice_num(gpio)].level[pwm_gpio_to_channel(gpio)] = level;
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+  pwm_slices[slice_num].enabled = enabled;
+}
+
+// --- ADC ---
+//
+// Conversões a 48 MHz / (1 + div), 96 ciclos no mínimo. Com o FIFO e o DREQ
+// habilitados, cada amostra vai para o canal DMA que estiver esperando.
+
+#define SIM_ADC_INPUTS 5
+#define SIM_ADC_FIFO_DEPTH 4
+
+static adc_hw_t adc_regs;
+adc_hw_t *const adc_hw = &adc_regs;
+
+static struct {
+  uint16_t value[SIM_ADC_INPUTS];
+  uint input;
+  uint round_robin;
+  uint32_t div_q8; // Divisor em 16.8
+  bool running;
+  bool fifo_en;
+  bool dreq_en;
+  uint64_t start_us;
+  uint64_t produced; // Amostras geradas desde adc_run(true)
+  uint16_t fifo[SIM_ADC_FIFO_DEPTH];
+  uint8_t fifo_level;
+} adc_sim = {
+  // Joystick centrado por padrão
+  .value = { 2048, 2048, 2048, 2048, 876 },
+};
+
+void sim_adc_set(uint input, uint16_t value) {
+  adc_sim.value[input] = value & 0x0FFF;
+}
+
+static uint16_t sim_adc_convert(void) {
+  uint16_t sample = adc_sim.value[adc_sim.input];
+  if (adc_sim.round_robin) {
+    do {
+      adc_sim.input = (adc_sim.input + 1) % SIM_ADC_INPUTS;
+    } while (!(adc_sim.round_robin & (1u << adc_sim.input)));
+  }
+  return sample;
+}
+
+void sim_adc_advance(uint64_t until_us) {
+  if (!adc_sim.running || until_us <= adc_sim.start_us)
+    return;
+  // Amostra k sai em start + k * (1 + div) / 48 MHz
+  uint64_t period_q8 = 256 + adc_sim.div_q8;
+  uint64_t due = (until_us - adc_sim.start_us) * 48 * 256 / period_q8;
+  for (; adc_sim.produced < due; ++adc_sim.produced) {
+    uint16_t sample = sim_adc_convert();
+    if (!adc_sim.fifo_en)
+      continue;
+    if (adc_sim.dreq_en && sim_dma_dreq(DREQ_ADC, sample))
+      continue;
+    if (adc_sim.fifo_level < SIM_ADC_FIFO_DEPTH)
+      adc_sim.fifo[adc_sim.fifo_level++] = sample;
+  }
+}
+
+void adc_init(void) {
+  adc_sim.running = false;
+  adc_sim.input = 0;
+  adc_sim.round_robin = 0;
+  adc_sim.fifo_level = 0;
+}
+
+void adc_gpio_init(uint gpio) {
+  gpio_set_function(gpio, GPIO_FUNC_NULL);
+  gpio_disable_pulls(gpio);
+}
+
+void adc_select_input(uint input) {
+  adc_sim.input = input % SIM_ADC_INPUTS;
+}
+
+uint adc_get_selected_input(void) {
+  return adc_sim.input;
+}
+
+void adc_set_round_robin(uint input_mask) {
+  adc_sim.round_robin = input_mask & 0x1f;
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {
+  (void)enable;
+}
+
+uint16_t adc_read(void) {
+  return sim_adc_convert();
+}
+
+void adc_run(bool run) {
+  if (run && !adc_sim.running) {
+    adc_sim.start_us = sim_now_us();
+    adc_sim.produced = 0;
+  }
+  adc_sim.running = run;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+  adc_sim.div_q8 = (uint32_t)(clkdiv * 256.0f);
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+  (void)dreq_thresh;
+  (void)err_in_fifo;
+  (void)byte_shift;
+  adc_sim.fifo_en = en;
+  adc_sim.dreq_en = dreq_en;
+}
+
+bool adc_fifo_is_empty(void) {
+  return adc_sim.fifo_level == 0;
+}
+
+uint8_t adc_fifo_get_level(void) {
+  return adc_sim.fifo_level;
+}
+
+uint16_t adc_fifo_get(void) {
+  if (adc_sim.fifo_level == 0)
+    return 0;
+  uint16_t sample = adc_sim.fifo[0];
+  memmove(adc_sim.fifo, adc_sim.fifo + 1, --adc_sim.fifo_level * sizeof(uint16_t));
+  return sample;
+}
+
+void adc_fifo_drain(void) {
+  adc_sim.fifo_level = 0;
+}
+
+// --- I2C ---
+
+static i2c_hw_t i2c_regs[2];
+i2c_inst_t i2c0_inst = { &i2c_regs[0], 0 };
+i2c_inst_t i2c1_inst = { &i2c_regs[1], 0 };
+
+static struct {
+  bool in_transaction;
+  bool acked;
+  bool stuck;       // Um escravo segura o SDA: nada anda no barramento
+  uint scl_pulses;  // Pulsos de SCL por GPIO desde que travou
+  sim_i2c_stats_t stats;
+} i2c_sim[2];
+
+static void sim_dma_resume_i2c(uint port);
+
+void sim_i2c_get_stats(uint port, sim_i2c_stats_t *stats) {
+  *stats = i2c_sim[port].stats;
+}
+
+// Só o SSD1306 responde, no endereço padrão
+static bool sim_i2c_start(uint port, uint8_t addr) {
+  i2c_sim[port].in_transaction = true;
+  i2c_sim[port].acked = addr == SIM_SSD1306_ADDRESS;
+  i2c_sim[port].stats.transactions++;
+  if (!i2c_sim[port].acked) {
+    i2c_sim[port].stats.naks++;
+    i2c_regs[port].raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+    return false;
+  }
+  sim_ssd1306_start(sim_ssd1306_get(port));
+  return true;
+}
+
+static void sim_i2c_byte(uint port, uint8_t byte) {
+  if (!i2c_sim[port].acked)
+    return;
+  i2c_sim[port].stats.bytes++;
+  sim_ssd1306_byte(sim_ssd1306_get(port), byte);
+}
+
+static void sim_i2c_stop(uint port) {
+  if (i2c_sim[port].acked)
+    sim_ssd1306_stop(sim_ssd1306_get(port));
+  i2c_sim[port].in_transaction = false;
+}
+
+// Palavra escrita em IC_DATA_CMD (pela DMA)
+static void sim_i2c_data_cmd(uint port, uint32_t word) {
+  if (!i2c_sim[port].in_transaction || (word & I2C_IC_DATA_CMD_RESTART_BITS))
+    sim_i2c_start(port, (uint8_t)i2c_regs[port].tar);
+  sim_i2c_byte(port, word & I2C_IC_DATA_CMD_DAT_BITS);
+  if (word & I2C_IC_DATA_CMD_STOP_BITS)
+    sim_i2c_stop(port);
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+  uint port = i2c_hw_index(i2c);
+  i2c_regs[port].enable = 1;
+  i2c_regs[port].status = I2C_IC_STATUS_TFE_BITS | I2C_IC_STATUS_TFNF_BITS;
+  return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t *i2c) {
+  i2c_regs[i2c_hw_index(i2c)].enable = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+  i2c->baudrate = baudrate;
+  return baudrate;
+}
+
+void sim_i2c_hold(uint port, bool stuck) {
+  i2c_sim[port].stuck = stuck;
+  i2c_sim[port].scl_pulses = 0;
+  if (!stuck) {
+    sim_dma_resume_i2c(port);
+    __sev(); // Acorda quem esperava o barramento
+  }
+}
+
+#define SIM_I2C_PULSOS_SOLTAR 5 // Preso no meio de um byte: faltam 4 bits e o ACK
+
+static bool sim_i2c_sda_held(uint port) {
+  return i2c_sim[port].stuck;
+}
+
+// O escravo preso termina o byte que achava estar enviando e solta o SDA
+static void sim_i2c_scl_rise(uint port) {
+  if (i2c_sim[port].stuck && ++i2c_sim[port].scl_pulses == SIM_I2C_PULSOS_SOLTAR)
+    sim_i2c_hold(port, false);
+}
+
+// Espera o barramento ser solto até o prazo; false se ele venceu antes
+static bool sim_i2c_wait_bus(uint port, uint64_t deadline_us) {
+  while (i2c_sim[port].stuck) {
+    if (sim_wait_until(deadline_us))
+      return false;
+  }
+  return true;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  uint port = i2c_hw_index(i2c);
+  sim_i2c_wait_bus(port, UINT64_MAX); // Como no SDK, sem prazo: trava junto
+  if (!sim_i2c_start(port, addr)) {
+    sim_i2c_stop(port);
+    return PICO_ERROR_GENERIC;
+  }
+  for (size_t i = 0; i < len; ++i)
+    sim_i2c_byte(port, src[i]);
+  if (!nostop)
+    sim_i2c_stop(port);
+  return (int)len;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop,
+                         uint timeout_us) {
+  if (!sim_i2c_wait_bus(i2c_hw_index(i2c), sim_now_us() + timeout_us))
+    return PICO_ERROR_TIMEOUT;
+  return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+  uint port = i2c_hw_index(i2c);
+  sim_i2c_wait_bus(port, UINT64_MAX);
+  if (!sim_i2c_start(port, addr)) {
+    sim_i2c_stop(port);
+    return PICO_ERROR_GENERIC;
+  }
+  // O SSD1306 em I2C não devolve dados; lê o byte de status como zero
+  memset(dst, 0, len);
+  if (!nostop)
+    sim_i2c_stop(port);
+  return (int)len;
+}
+
+// --- DMA ---
+//
+// Canais com DREQ do I2C (ou sem DREQ) terminam no instante em que são
+// disparados, ou, com o barramento travado, quando ele é solto; canais do
+// ADC avançam uma palavra por amostra convertida.
+
+typedef struct {
+  dma_channel_hw_t hw;
+  dma_channel_config config;
+  uint32_t reload_count; // TRANS_COUNT recarregado a cada disparo
+  bool claimed;
+  bool busy;
+  bool irq0_enabled, irq1_enabled;
+  bool irq0_status, irq1_status;
+} sim_dma_channel_t;
+
+static sim_dma_channel_t dma_channels[NUM_DMA_CHANNELS];
+
+static void sim_dma_start(uint channel);
+
+static uint32_t sim_dma_read(sim_dma_channel_t *c) {
+  uint32_t value = 0;
+  const volatile void *src = (const volatile void *)c->hw.read_addr;
+  switch (c->config.size) {
+    case DMA_SIZE_8: value = *(const volatile uint8_t *)src; break;
+    case DMA_SIZE_16: value = *(const volatile uint16_t *)src; break;
+    default: value = *(const volatile uint32_t *)src; break;
+  }
+  if (c->config.incr_read)
+    c->hw.read_addr += 1u << c->config.size;
+  return value;
+}
+
+static void sim_dma_write(sim_dma_channel_t *c, uint32_t value) {
+  uintptr_t addr = c->hw.write_addr;
+  for (uint port = 0; port < 2; ++port) {
+    if (addr == (uintptr_t)&i2c_regs[port].data_cmd) {
+      sim_i2c_data_cmd(port, value);
+      return;
+    }
+  }
+  volatile void *dst = (volatile void *)addr;
+  switch (c->config.size) {
+    case DMA_SIZE_8: *(volatile uint8_t *)dst = (uint8_t)value; break;
+    case DMA_SIZE_16: *(volatile uint16_t *)dst = (uint16_t)value; break;
+    default: *(volatile uint32_t *)dst = value; break;
+  }
+  if (c->config.incr_write) {
+    uintptr_t next = addr + (1u << c->config.size);
+    if (c->config.ring_write && c->config.ring_bits) {
+      uintptr_t mask = ((uintptr_t)1 << c->config.ring_bits) - 1;
+      next = (addr & ~mask) | (next & mask);
+    }
+    c->hw.write_addr = next;
+  }
+}
+
+static void sim_dma_complete(uint channel) {
+  sim_dma_channel_t *c = &dma_channels[channel];
+  c->busy = false;
+  if (c->irq0_enabled) {
+    c->irq0_status = true;
+    sim_irq_raise(DMA_IRQ_0);
+  }
+  if (c->irq1_enabled) {
+    c->irq1_status = true;
+    sim_irq_raise(DMA_IRQ_1);
+  }
+  if (c->config.chain_to != channel)
+    sim_dma_start(c->config.chain_to);
+}
+
+static bool sim_dma_is_paced(uint8_t dreq) {
+  return dreq == DREQ_ADC;
+}
+
+// Porta I2C em que o canal escreve, ou -1
+static int sim_dma_i2c_port(const sim_dma_channel_t *c) {
+  for (uint port = 0; port < 2; ++port)
+    if (c->hw.write_addr == (uintptr_t)&i2c_regs[port].data_cmd)
+      return (int)port;
+  return -1;
+}
+
+static void sim_dma_run(uint channel) {
+  sim_dma_channel_t *c = &dma_channels[channel];
+  while (c->hw.transfer_count) {
+    sim_dma_write(c, sim_dma_read(c));
+    --c->hw.transfer_count;
+  }
+  sim_dma_complete(channel);
+}
+
+static void sim_dma_resume_i2c(uint port) {
+  for (uint channel = 0; channel < NUM_DMA_CHANNELS; ++channel) {
+    sim_dma_channel_t *c = &dma_channels[channel];
+    if (c->busy && sim_dma_i2c_port(c) == (int)port)
+      sim_dma_run(channel);
+  }
+}
+
+static void sim_dma_start(uint channel) {
+  sim_dma_channel_t *c = &dma_channels[channel];
+  if (!c->config.enable)
+    return;
+  c->hw.transfer_count = c->reload_count;
+  c->busy = c->hw.transfer_count > 0;
+  if (!c->busy) {
+    sim_dma_complete(channel);
+    return;
+  }
+  if (sim_dma_is_paced(c->config.dreq))
+    return;
+
+  int port = sim_dma_i2c_port(c);
+  if (port >= 0) {
+    i2c_regs[port].raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS; // Limpo pela leitura de IC_CLR_TX_ABRT
+    if (i2c_sim[port].stuck)
+      return; // Fica ocupado até sim_i2c_hold() soltar o barramento
+  }
+  sim_dma_run(channel);
+}
+
+bool sim_dma_dreq(uint dreq, uint32_t value) {
+  for (uint channel = 0; channel < NUM_DMA_CHANNELS; ++channel) {
+    sim_dma_channel_t *c = &dma_channels[channel];
+    if (!c->busy || c->config.dreq != dreq)
+      continue;
+    sim_dma_write(c, value);
+    if (--c->hw.transfer_count == 0)
+      sim_dma_complete(channel);
+    return true;
+  }
+  return false;
+}
+
+int dma_claim_unused_channel(bool required) {
+  for (uint channel = 0; channel < NUM_DMA_CHANNELS; ++channel) {
+    if (!dma_channels[channel].claimed) {
+      dma_channels[channel].claimed = true;
+      return (int)channel;
+    }
+  }
+  if (required) {
+    fprintf(stderr, "sim: nenhum canal DMA livre\n");
+    exit(1);
+  }
+  return -1;
+}
+
+void dma_channel_claim(uint channel) {
+  dma_channels[channel].claimed = true;
+}
+
+void dma_channel_unclaim(uint channel) {
+  dma_channels[channel].claimed = false;
+}
+
+bool dma_channel_is_claimed(uint channel) {
+  return dma_channels[channel].claimed;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  dma_channel_config c = {
+    .size = DMA_SIZE_32,
+    .incr_read = true,
+    .incr_write = false,
+    .dreq = DREQ_FORCE,
+    .chain_to = (uint8_t)channel,
+    .enable = true,
+  };
+  return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+  c->size = (uint8_t)size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+  c->incr_read = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+  c->incr_write = incr;
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits) {
+  c->ring_write = write;
+  c->ring_bits = (uint8_t)size_bits;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+  c->dreq = (uint8_t)dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) {
+  c->chain_to = (uint8_t)chain_to;
+}
+
+void channel_config_set_enable(dma_channel_config *c, bool enable) {
+  c->enable = enable;
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel) {
+  return &dma_channels[channel].hw;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+  sim_dma_channel_t *c = &dma_channels[channel];
+  c->config = *config;
+  c->hw.write_addr = (uintptr_t)write_addr;
+  c->hw.read_addr = (uintptr_t)read_addr;
+  c->reload_count = transfer_count;
+  c->hw.transfer_count = transfer_count;
+  if (trigger)
+    sim_dma_start(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+  sim_dma_channel_t *c = &dma_channels[channel];
+  c->hw.read_addr = (uintptr_t)read_addr;
+  c->reload_count = transfer_count;
+  sim_dma_start(channel);
+}
+
+void dma_channel_start(uint channel) {
+  sim_dma_start(channel);
+}
+
+void dma_channel_abort(uint channel) {
+  dma_channels[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+  return dma_channels[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  while (dma_channel_is_busy(channel))
+    tight_loop_contents();
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+  dma_channels[channel].irq0_enabled = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+  dma_channels[channel].irq1_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+  return dma_channels[channel].irq0_status;
+}
+
+bool dma_channel_get_irq1_status(uint channel) {
+  return dma_channels[channel].irq1_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+  dma_channels[channel].irq0_status = false;
+}
+
+void dma_channel_acknowledge_irq1(uint channel) {
+  dma_channels[channel].irq1_status = false;
+}
+
+// --- Fila entre núcleos (sem trava: os núcleos simulados nunca rodam juntos) ---
+
+void queue_init(queue_t *q, uint element_size, uint element_count) {
+  q->data = calloc(element_count + 1, element_size);
+  q->element_size = (uint16_t)element_size;
+  q->element_count = (uint16_t)element_count;
+  q->wptr = 0;
+  q->rptr = 0;
+}
+
+void queue_free(queue_t *q) {
+  free(q->data);
+  q->data = NULL;
+}
+
+uint queue_get_level(queue_t *q) {
+  int level = (int)q->wptr - (int)q->rptr;
+  if (level < 0)
+    level += q->element_count + 1;
+  return (uint)level;
+}
+
+bool queue_is_empty(queue_t *q) {
+  return queue_get_level(q) == 0;
+}
+
+bool queue_is_full(queue_t *q) {
+  return queue_get_level(q) == q->element_count;
+}
+
+bool queue_try_add(queue_t *q, const void *data) {
+  if (queue_is_full(q))
+    return false;
+  memcpy(q->data + (size_t)q->wptr * q->element_size, data, q->element_size);
+  q->wptr = (uint16_t)((q->wptr + 1) % (q->element_count + 1));
+  return true;
+}
+
+bool queue_try_peek(queue_t *q, void *data) {
+  if (queue_is_empty(q))
+    return false;
+  memcpy(data, q->data + (size_t)q->rptr * q->element_size, q->element_size);
+  return true;
+}
+
+bool queue_try_remove(queue_t *q, void *data) {
+  if (!queue_try_peek(q, data))
+    return false;
+  q->rptr = (uint16_t)((q->rptr + 1) % (q->element_count + 1));
+  return true;
+}
+
+// --- Flash ---
+
+// Mapeada como compartilhada para sobreviver aos reinícios pelo watchdog,
+// que rodam o firmware num processo novo
+uint8_t *sim_flash_memory;
+static const char *flash_image_path;
+static uint32_t flash_erases, flash_pages;
+
+bool sim_flash_load(const char *path) {
+  sim_flash_memory = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (sim_flash_memory == MAP_FAILED) {
+    perror("mmap");
+    return false;
+  }
+  memset(sim_flash_memory, 0xFF, PICO_FLASH_SIZE_BYTES);
+  flash_image_path = path;
+  if (!path)
+    return true;
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return true; // Imagem nova: criada no fim da simulação
+  size_t n = fread(sim_flash_memory, 1, PICO_FLASH_SIZE_BYTES, f);
+  fclose(f);
+  if (n != PICO_FLASH_SIZE_BYTES) {
+    fprintf(stderr, "%s: imagem da flash com %zu bytes, esperado %u\n", path, n,
+            (unsigned)PICO_FLASH_SIZE_BYTES);
+    return false;
+  }
+  return true;
+}
+
+void sim_flash_save(void) {
+  if (!flash_image_path)
+    return;
+  FILE *f = fopen(flash_image_path, "wb");
+  if (!f || fwrite(sim_flash_memory, 1, PICO_FLASH_SIZE_BYTES, f) != PICO_FLASH_SIZE_BYTES)
+    perror(flash_image_path);
+  if (f)
+    fclose(f);
+}
+
+void sim_flash_get_stats(uint32_t *erases, uint32_t *pages) {
+  *erases = flash_erases;
+  *pages = flash_pages;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+  if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+    fprintf(stderr, "flash: apagamento desalinhado em 0x%06x (%zu bytes)\n", (unsigned)flash_offs, count);
+    abort();
+  }
+  memset(sim_flash_memory + flash_offs, 0xFF, count);
+  flash_erases += (uint32_t)(count / FLASH_SECTOR_SIZE);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+  if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+    fprintf(stderr, "flash: gravação desalinhada em 0x%06x (%zu bytes)\n", (unsigned)flash_offs, count);
+    abort();
+  }
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t *cell = &sim_flash_memory[flash_offs + i];
+    if (data[i] & ~*cell)
+      fprintf(stderr, "flash: bit 0 -> 1 sem apagar em 0x%06x\n", (unsigned)(flash_offs + i));
+    *cell &= data[i];
+  }
+  flash_pages += (uint32_t)(count / FLASH_PAGE_SIZE);
+}
+
+bool flash_safe_execute_core_init(void) {
+  return true;
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+  (void)enter_exit_timeout_ms;
+  func(param);
+  return PICO_OK;
+}
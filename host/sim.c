@@ -0,0 +1,695 @@
+#include "sim.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+
+// Como no SDK: o maior instante positivo, para que absolute_time_diff_us()
+// até ele dê positivo
+const absolute_time_t at_the_end_of_time = INT64_MAX;
+const absolute_time_t nil_time = 0;
+
+static uint64_t now_us;  // Relógio do firmware, zerado a cada boot
+static uint64_t boot_us; // Instante do boot atual no relógio do roteiro
+
+// Estado que passa de um boot para o seguinte (memória compartilhada)
+typedef struct {
+  uint32_t resets;
+  uint64_t reset_us;  // Último reinício, no relógio do roteiro
+  size_t script_pos;  // Passos do roteiro já aplicados até ele
+  uint8_t retained[]; // Cópia da seção sim_retida
+} sim_boot_state_t;
+
+static sim_boot_state_t *boot_state;
+
+// --- Revezamento dos núcleos ---
+//
+// Cada núcleo é uma thread, mas só a que tem a "vez" executa. O núcleo 0 é
+// quem avança o relógio; antes de avançar, ele passa a vez ao núcleo 1
+// enquanto este tiver algo a fazer (evento, IRQ pendente ou prazo vencido).
+
+static pthread_mutex_t turn_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t turn_cond = PTHREAD_COND_INITIALIZER;
+static uint active_core;
+static __thread uint current_core;
+
+static void (*core1_entry)(void);
+static bool core1_launched;
+static uint64_t core1_deadline = UINT64_MAX;
+static volatile bool event_flag[2]; // Registrador de evento de cada núcleo
+
+static void sim_pass_turn(uint to) {
+  pthread_mutex_lock(&turn_lock);
+  active_core = to;
+  pthread_cond_broadcast(&turn_cond);
+  while (active_core != current_core)
+    pthread_cond_wait(&turn_cond, &turn_lock);
+  pthread_mutex_unlock(&turn_lock);
+}
+
+static void *sim_core1_thread(void *arg) {
+  (void)arg;
+  current_core = 1;
+  pthread_mutex_lock(&turn_lock);
+  while (active_core != 1)
+    pthread_cond_wait(&turn_cond, &turn_lock);
+  pthread_mutex_unlock(&turn_lock);
+
+  core1_entry();
+
+  // O núcleo 1 retornou: fica parado para sempre
+  core1_launched = false;
+  sim_pass_turn(0);
+  return NULL;
+}
+
+uint get_core_num(void) {
+  return current_core;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+  pthread_t thread;
+  core1_entry = entry;
+  core1_launched = true;
+  event_flag[1] = true; // Começa a rodar na primeira espera do núcleo 0
+  if (pthread_create(&thread, NULL, sim_core1_thread, NULL) != 0) {
+    perror("pthread_create");
+    exit(1);
+  }
+  pthread_detach(thread);
+}
+
+// --- IRQs ---
+
+#define SIM_MAX_SHARED_HANDLERS 4
+
+static irq_handler_t irq_handlers[NUM_IRQS][SIM_MAX_SHARED_HANDLERS];
+static bool irq_enabled[2][NUM_IRQS];
+static bool irq_pending[2][NUM_IRQS];
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+  memset(irq_handlers[num], 0, sizeof(irq_handlers[num]));
+  irq_handlers[num][0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+  (void)order_priority;
+  for (uint i = 0; i < SIM_MAX_SHARED_HANDLERS; ++i) {
+    if (!irq_handlers[num][i]) {
+      irq_handlers[num][i] = handler;
+      return;
+    }
+  }
+  fprintf(stderr, "sim: handlers demais na IRQ %u\n", num);
+  exit(1);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+  for (uint i = 0; i < SIM_MAX_SHARED_HANDLERS; ++i)
+    if (irq_handlers[num][i] == handler)
+      irq_handlers[num][i] = NULL;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+  irq_enabled[current_core][num] = enabled;
+}
+
+void sim_irq_raise(uint num) {
+  for (uint core = 0; core < 2; ++core)
+    if (irq_enabled[core][num])
+      irq_pending[core][num] = true;
+}
+
+static bool sim_irq_any_pending(uint core) {
+  for (uint num = 0; num < NUM_IRQS; ++num)
+    if (irq_pending[core][num])
+      return true;
+  return false;
+}
+
+void sim_irq_service(void) {
+  uint core = current_core;
+  for (uint num = 0; num < NUM_IRQS; ++num) {
+    if (!irq_pending[core][num])
+      continue;
+    irq_pending[core][num] = false;
+    for (uint i = 0; i < SIM_MAX_SHARED_HANDLERS; ++i)
+      if (irq_handlers[num][i])
+        irq_handlers[num][i]();
+  }
+}
+
+// --- Alarmes (pool padrão, atendidos pelo núcleo 0) ---
+
+typedef struct {
+  alarm_id_t id;
+  uint64_t time_us;
+  alarm_callback_t callback;
+  void *user_data;
+} sim_alarm_t;
+
+static sim_alarm_t alarms[PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS];
+static alarm_id_t next_alarm_id = 1;
+
+static sim_alarm_t *sim_next_alarm(void) {
+  sim_alarm_t *next = NULL;
+  for (uint i = 0; i < PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS; ++i) {
+    sim_alarm_t *a = &alarms[i];
+    if (a->id && (!next || a->time_us < next->time_us || (a->time_us == next->time_us && a->id < next->id)))
+      next = a;
+  }
+  return next;
+}
+
+// Executa o callback e reagenda conforme o retorno (< 0: a partir do horário
+// agendado, > 0: a partir de agora, 0: encerra). Retorna o id ou 0.
+static alarm_id_t sim_fire_alarm(sim_alarm_t *slot) {
+  alarm_id_t id = slot->id;
+  int64_t r = slot->callback(id, slot->user_data);
+  if (slot->id != id)
+    return 0; // Cancelado dentro do próprio callback
+  if (r == 0) {
+    slot->id = 0;
+    return 0;
+  }
+  slot->time_us = r < 0 ? slot->time_us - r : now_us + r;
+  return id;
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  sim_alarm_t *slot = NULL;
+  for (uint i = 0; i < PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS && !slot; ++i)
+    if (!alarms[i].id)
+      slot = &alarms[i];
+  if (!slot)
+    return -1;
+  if (time <= now_us && !fire_if_past)
+    return 0;
+
+  slot->id = next_alarm_id++;
+  if (next_alarm_id <= 0)
+    next_alarm_id = 1;
+  slot->time_us = time;
+  slot->callback = callback;
+  slot->user_data = user_data;
+  if (time <= now_us)
+    return sim_fire_alarm(slot);
+  return slot->id;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(delayed_by_us(now_us, us), callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(delayed_by_ms(now_us, ms), callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+  for (uint i = 0; i < PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS; ++i) {
+    if (alarm_id > 0 && alarms[i].id == alarm_id) {
+      alarms[i].id = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+// --- Roteiro ---
+
+typedef enum {
+  SIM_STEP_GPIO,
+  SIM_STEP_ADC,
+  SIM_STEP_SCREEN,
+  SIM_STEP_SERIAL,
+  SIM_STEP_I2C,
+  SIM_STEP_END
+} sim_step_kind_t;
+
+typedef struct {
+  uint64_t time_us;
+  sim_step_kind_t kind;
+  uint arg;
+  int value;
+  char *text; // Linha recebida pela serial (SIM_STEP_SERIAL)
+  size_t order; // Posição no arquivo, para desempatar eventos no mesmo instante
+} sim_step_t;
+
+static sim_step_t *script;
+static size_t script_len;
+static size_t script_pos;
+
+static int sim_step_compare(const void *a, const void *b) {
+  const sim_step_t *x = a, *y = b;
+  if (x->time_us != y->time_us)
+    return x->time_us < y->time_us ? -1 : 1;
+  return x->order < y->order ? -1 : 1;
+}
+
+bool sim_load_script(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+
+  size_t capacity = 0;
+  char line[256];
+  unsigned number = 0;
+  while (fgets(line, sizeof(line), f)) {
+    ++number;
+    char *p = line + strspn(line, " \t");
+    if (*p == '#' || *p == '\n' || *p == '\0')
+      continue;
+
+    double seconds;
+    char kind[16], a[16] = "", b[16] = "";
+    int n = sscanf(p, "%lf %15s %15s %15s", &seconds, kind, a, b);
+    sim_step_t step = { .time_us = (uint64_t)(seconds * 1e6 + 0.5) };
+    bool ok = n >= 2 && seconds >= 0;
+    if (ok && strcmp(kind, "gpio") == 0 && n == 4) {
+      step.kind = SIM_STEP_GPIO;
+      step.arg = (uint)atoi(a);
+      step.value = (b[0] == 'z') ? -1 : atoi(b) != 0;
+      ok = step.arg < NUM_BANK0_GPIOS;
+    } else if (ok && strcmp(kind, "adc") == 0 && n == 4) {
+      step.kind = SIM_STEP_ADC;
+      step.arg = (uint)atoi(a);
+      step.value = atoi(b);
+      ok = step.arg < 5 && step.value >= 0 && step.value <= 4095;
+    } else if (ok && strcmp(kind, "tela") == 0) {
+      step.kind = SIM_STEP_SCREEN;
+    } else if (ok && strcmp(kind, "serial") == 0 && n >= 3) {
+      // O texto é o resto da linha depois da palavra "serial"
+      char *text = strstr(p, "serial") + strlen("serial");
+      text += strspn(text, " \t");
+      text[strcspn(text, "\r\n")] = '\0';
+      step.kind = SIM_STEP_SERIAL;
+      step.text = strdup(text);
+    } else if (ok && strcmp(kind, "i2c") == 0 && n == 4) {
+      step.kind = SIM_STEP_I2C;
+      step.arg = (uint)atoi(a);
+      step.value = strcmp(b, "travar") == 0;
+      ok = step.arg < 2 && (step.value || strcmp(b, "soltar") == 0);
+    } else if (ok && strcmp(kind, "fim") == 0) {
+      step.kind = SIM_STEP_END;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      fprintf(stderr, "%s:%u: linha inválida: %s", path, number, line);
+      fclose(f);
+      return false;
+    }
+
+    if (script_len == capacity) {
+      capacity = capacity ? capacity * 2 : 32;
+      script = realloc(script, capacity * sizeof(sim_step_t));
+    }
+    step.order = script_len;
+    script[script_len++] = step;
+  }
+  fclose(f);
+
+  qsort(script, script_len, sizeof(sim_step_t), sim_step_compare);
+  return true;
+}
+
+static void sim_print_time(FILE *out) {
+  uint64_t ms = (boot_us + now_us) / 1000;
+  fprintf(out, "[sim %02u:%02u:%02u.%03u] ", (unsigned)(ms / 3600000), (unsigned)(ms / 60000 % 60),
+          (unsigned)(ms / 1000 % 60), (unsigned)(ms % 1000));
+}
+
+static bool core1_has_work(void) {
+  return core1_launched && (event_flag[1] || sim_irq_any_pending(1) || now_us >= core1_deadline);
+}
+
+// Deixa o núcleo 1 rodar até ele voltar a esperar sem nada pendente
+static void sim_run_core1(void) {
+  while (current_core == 0 && core1_has_work())
+    sim_pass_turn(1);
+}
+
+static void sim_print_screens(void) {
+  for (uint port = 0; port < 2; ++port) {
+    sim_ssd1306_t *d = sim_ssd1306_get(port);
+    sim_i2c_stats_t stats;
+    sim_i2c_get_stats(port, &stats);
+    if (stats.transactions == 0)
+      continue;
+    sim_print_time(stdout);
+    printf("tela i2c%u\n", port);
+    sim_ssd1306_print(d, stdout);
+  }
+}
+
+static void sim_finish(void) {
+  sim_run_core1();
+  fflush(stdout);
+  sim_print_screens();
+  for (uint port = 0; port < 2; ++port) {
+    sim_i2c_stats_t stats;
+    sim_i2c_get_stats(port, &stats);
+    if (stats.transactions == 0)
+      continue;
+    sim_print_time(stdout);
+    printf("i2c%u: %u bytes em %u transações, %u sem resposta\n", port, (unsigned)stats.bytes,
+           (unsigned)stats.transactions, (unsigned)stats.naks);
+  }
+  uint32_t erases, pages;
+  sim_flash_get_stats(&erases, &pages);
+  if (erases || pages) {
+    sim_print_time(stdout);
+    printf("flash: %u setores apagados, %u páginas gravadas\n", (unsigned)erases, (unsigned)pages);
+  }
+  uint32_t clock_changes;
+  uint64_t reduced_us;
+  sim_clock_get_stats(&clock_changes, &reduced_us);
+  if (clock_changes) {
+    sim_print_time(stdout);
+    printf("clk_sys: %u trocas, %u s com clock reduzido\n", (unsigned)clock_changes,
+           (unsigned)(reduced_us / 1000000));
+  }
+  if (boot_state && boot_state->resets) {
+    sim_print_time(stdout);
+    printf("watchdog: %u reinícios (estatísticas desde o último)\n", (unsigned)boot_state->resets);
+  }
+  sim_flash_save();
+  fflush(stdout);
+  exit(0);
+}
+
+// --- Entrada da stdio ---
+
+static char serial_input[256];
+static size_t serial_head, serial_tail;
+static void (*serial_callback)(void *);
+static void *serial_callback_param;
+
+static void sim_serial_receive(const char *text) {
+  for (const char *c = text;; ++c) {
+    char byte = *c ? *c : '\n';
+    size_t next = (serial_head + 1) % sizeof(serial_input);
+    if (next == serial_tail)
+      break; // Buffer cheio: o resto se perde, como num FIFO de UART
+    serial_input[serial_head] = byte;
+    serial_head = next;
+    if (!*c)
+      break;
+  }
+  if (serial_callback)
+    serial_callback(serial_callback_param);
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+  uint64_t deadline = now_us + timeout_us;
+  while (serial_head == serial_tail) {
+    if (timeout_us == 0 || sim_wait_until(deadline))
+      return PICO_ERROR_TIMEOUT;
+  }
+  int c = (unsigned char)serial_input[serial_tail];
+  serial_tail = (serial_tail + 1) % sizeof(serial_input);
+  return c;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param) {
+  serial_callback = fn;
+  serial_callback_param = param;
+}
+
+// Aplica um passo do roteiro; GPIO com IRQ habilitada deixa a IRQ pendente
+static void sim_apply_step(const sim_step_t *step) {
+  switch (step->kind) {
+    case SIM_STEP_GPIO:
+      sim_gpio_drive(step->arg, step->value);
+      break;
+    case SIM_STEP_ADC:
+      sim_adc_set(step->arg, (uint16_t)step->value);
+      break;
+    case SIM_STEP_SCREEN:
+      sim_run_core1();
+      fflush(stdout);
+      sim_print_screens();
+      break;
+    case SIM_STEP_SERIAL:
+      sim_serial_receive(step->text);
+      break;
+    case SIM_STEP_I2C:
+      sim_i2c_hold(step->arg, step->value);
+      break;
+    case SIM_STEP_END:
+      sim_finish();
+      break;
+  }
+}
+
+// --- Watchdog e reinício ---
+
+#define SIM_EXIT_WATCHDOG 3
+
+// Limites da seção sim_retida, definidos pelo ligador se ela existir
+extern uint8_t __start_sim_retida[] __attribute__((weak));
+extern uint8_t __stop_sim_retida[] __attribute__((weak));
+
+static uint64_t watchdog_load_us;
+static uint64_t watchdog_deadline = UINT64_MAX;
+
+static size_t sim_retained_size(void) {
+  return (size_t)(__stop_sim_retida - __start_sim_retida);
+}
+
+// Reaplica os níveis do roteiro anteriores ao reinício e passa os passos
+// seguintes para o relógio do boot novo
+static void sim_resume_script(void) {
+  boot_us = boot_state->reset_us;
+  for (script_pos = 0; script_pos < boot_state->script_pos; ++script_pos) {
+    const sim_step_t *step = &script[script_pos];
+    if (step->kind == SIM_STEP_GPIO || step->kind == SIM_STEP_ADC || step->kind == SIM_STEP_I2C)
+      sim_apply_step(step);
+  }
+  for (size_t i = script_pos; i < script_len; ++i)
+    script[i].time_us -= boot_us;
+}
+
+void sim_boot(void) {
+  size_t size = sizeof(sim_boot_state_t) + sim_retained_size();
+  boot_state = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (boot_state == MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+
+  // Cada boot é um filho saído deste processo, ainda com o estado inicial
+  for (;;) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      exit(1);
+    }
+    if (pid == 0) {
+      if (boot_state->resets) {
+        if (sim_retained_size())
+          memcpy(__start_sim_retida, boot_state->retained, sim_retained_size());
+        sim_resume_script();
+      }
+      return;
+    }
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+      perror("waitpid");
+      exit(1);
+    }
+    if (!WIFEXITED(status))
+      exit(1);
+    if (WEXITSTATUS(status) != SIM_EXIT_WATCHDOG)
+      exit(WEXITSTATUS(status));
+  }
+}
+
+static void sim_watchdog_reset(void) {
+  sim_print_time(stdout);
+  printf("watchdog: reinício\n");
+  fflush(stdout);
+  if (!boot_state)
+    exit(1); // Sem sim_boot() não há como reiniciar
+  if (sim_retained_size())
+    memcpy(boot_state->retained, __start_sim_retida, sim_retained_size());
+  boot_state->reset_us = boot_us + now_us;
+  boot_state->script_pos = script_pos;
+  boot_state->resets++;
+  _exit(SIM_EXIT_WATCHDOG);
+}
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+  (void)pause_on_debug;
+  watchdog_load_us = (uint64_t)delay_ms * 1000;
+  watchdog_update();
+}
+
+void watchdog_update(void) {
+  if (watchdog_load_us)
+    watchdog_deadline = now_us + watchdog_load_us;
+}
+
+void watchdog_disable(void) {
+  watchdog_load_us = 0;
+  watchdog_deadline = UINT64_MAX;
+}
+
+bool watchdog_caused_reboot(void) {
+  return boot_state && boot_state->resets > 0;
+}
+
+bool watchdog_enable_caused_reboot(void) {
+  return watchdog_caused_reboot();
+}
+
+// --- Relógio virtual ---
+
+uint64_t sim_now_us(void) {
+  return now_us;
+}
+
+uint64_t time_us_64(void) {
+  return now_us;
+}
+
+uint32_t time_us_32(void) {
+  return (uint32_t)now_us;
+}
+
+// Avança até o próximo acontecimento (no máximo até deadline_us) e o executa.
+// Retorna true se algo que acorda o núcleo 0 aconteceu.
+static bool sim_step(uint64_t deadline_us) {
+  uint64_t next = deadline_us;
+  sim_alarm_t *alarm = sim_next_alarm();
+  if (alarm && alarm->time_us < next)
+    next = alarm->time_us;
+  if (script_pos < script_len && script[script_pos].time_us < next)
+    next = script[script_pos].time_us;
+  if (core1_launched && core1_deadline < next)
+    next = core1_deadline;
+
+  if (next >= at_the_end_of_time) {
+    // Nada mais pode acontecer: o roteiro acabou sem "fim"
+    sim_finish();
+  }
+  if (watchdog_deadline < next)
+    next = watchdog_deadline;
+
+  if (next > now_us) {
+    sim_adc_advance(next);
+    if (now_us < next)
+      now_us = next;
+  }
+  if (now_us >= watchdog_deadline)
+    sim_watchdog_reset();
+
+  bool woke = false;
+  while ((alarm = sim_next_alarm()) && alarm->time_us <= now_us) {
+    sim_fire_alarm(alarm);
+    woke = true;
+  }
+  while (script_pos < script_len && script[script_pos].time_us <= now_us)
+    sim_apply_step(&script[script_pos++]);
+
+  if (sim_irq_any_pending(0)) {
+    sim_irq_service();
+    woke = true;
+  }
+  return woke;
+}
+
+bool sim_wait_until(uint64_t deadline_us) {
+  uint core = current_core;
+  sim_irq_service();
+  if (event_flag[core]) {
+    event_flag[core] = false;
+    return now_us >= deadline_us;
+  }
+
+  if (core == 1) {
+    // O núcleo 1 não avança o relógio: devolve a vez até ter algo a fazer
+    core1_deadline = deadline_us;
+    while (!event_flag[1] && !sim_irq_any_pending(1) && now_us < deadline_us)
+      sim_pass_turn(0);
+    core1_deadline = UINT64_MAX;
+    sim_irq_service();
+    event_flag[1] = false;
+    return now_us >= deadline_us;
+  }
+
+  for (;;) {
+    sim_run_core1();
+    if (event_flag[0]) {
+      event_flag[0] = false;
+      return now_us >= deadline_us;
+    }
+    if (now_us >= deadline_us)
+      return true;
+    if (sim_step(deadline_us)) {
+      event_flag[0] = false;
+      return now_us >= deadline_us;
+    }
+  }
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp) {
+  return sim_wait_until(timeout_timestamp);
+}
+
+void sleep_until(absolute_time_t t) {
+  while (!sim_wait_until(t))
+    ;
+}
+
+void sleep_us(uint64_t us) {
+  sleep_until(delayed_by_us(now_us, us));
+}
+
+void sleep_ms(uint32_t ms) {
+  sleep_until(delayed_by_ms(now_us, ms));
+}
+
+void busy_wait_us(uint64_t delay_us) {
+  sleep_us(delay_us);
+}
+
+void busy_wait_ms(uint32_t delay_ms) {
+  sleep_ms(delay_ms);
+}
+
+void tight_loop_contents(void) {
+  sim_wait_until(now_us + 1);
+}
+
+void __sev(void) {
+  event_flag[0] = true;
+  event_flag[1] = true;
+}
+
+void __wfe(void) {
+  sim_wait_until(UINT64_MAX);
+}
+
+void __wfi(void) {
+  sim_wait_until(UINT64_MAX);
+}
+
+bool stdio_init_all(void) {
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  return true;
+}
+
+int putchar_raw(int c) {
+  return putchar(c);
+}
@@ -0,0 +1,118 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+#include "pico.h"
+
+// Simulação em Linux do firmware sobre o shim do SDK (host/include).
+//
+// O tempo é virtual: nada acontece entre dois pontos de espera, e esperar
+// (sleep_ms, __wfe, best_effort_wfe_or_timeout) pula o relógio direto para o
+// próximo acontecimento - alarme, evento do roteiro, amostra do ADC ou prazo.
+// Um treino de 60 minutos roda em milissegundos de CPU.
+//
+// Os dois núcleos são threads que se revezam: só um roda por vez e a troca
+// acontece quando o núcleo ativo espera. Com isso a saída é determinística.
+
+#define SIM_SSD1306_ADDRESS 0x3C
+#define SIM_SSD1306_WIDTH 128
+#define SIM_SSD1306_PAGES 8
+
+// --- Relógio, núcleos e IRQs (sim.c) ---
+
+uint64_t sim_now_us(void);
+// Espera no núcleo atual até um evento, uma IRQ ou o prazo; true se o prazo venceu
+bool sim_wait_until(uint64_t deadline_us);
+// Marca a IRQ pendente nos núcleos em que está habilitada e atende a do núcleo atual
+void sim_irq_raise(uint num);
+void sim_irq_service(void);
+
+// --- Roteiro de entradas (sim.c) ---
+//
+// Uma linha por evento, com o instante em segundos desde o primeiro boot:
+//   <s> gpio <pino> <0|1|z>   nível aplicado externamente ao pino (z = solto)
+//   <s> adc <entrada> <valor>  valor de 12 bits lido pela entrada do ADC
+//   <s> serial <texto>         texto (mais '\n') chega na entrada da stdio
+//   <s> i2c <porta> <travar|soltar>  um escravo segura o SDA da porta ou solta;
+//                              pulsos de SCL pelos pinos como GPIO também o soltam
+//   <s> tela                   imprime o conteúdo do display
+//   <s> fim                    imprime o display e as estatísticas e encerra
+// Linhas vazias e começadas por '#' são ignoradas.
+bool sim_load_script(const char *path);
+
+// --- Watchdog e reinício (sim.c) ---
+//
+// O firmware roda num processo filho. Quando o prazo do watchdog vence, o
+// filho termina e um novo começa do zero, como depois de um reset: com o
+// relógio do firmware em 0, a flash (memória compartilhada) e a seção
+// "sim_retida" (__uninitialized_ram) de antes, e os níveis do roteiro até o
+// reinício já aplicados. O roteiro continua no mesmo ponto.
+// Chamado uma vez antes do firmware; retorna no processo que o executa.
+void sim_boot(void);
+
+// --- Periféricos (perifericos.c) ---
+
+// Gera as amostras do ADC e as transferências por DREQ até o instante dado
+void sim_adc_advance(uint64_t until_us);
+void sim_adc_set(uint input, uint16_t value);
+void sim_gpio_drive(uint gpio, int level); // level < 0 solta o pino
+// Entrega uma palavra a um canal DMA pendurado no DREQ; false se nenhum a aceitou
+bool sim_dma_dreq(uint dreq, uint32_t value);
+
+typedef struct {
+  uint32_t bytes;        // Bytes de dados (sem o byte de endereço)
+  uint32_t transactions; // Transações (START ... STOP)
+  uint32_t naks;         // Transações sem dispositivo no endereço
+} sim_i2c_stats_t;
+
+void sim_i2c_get_stats(uint port, sim_i2c_stats_t *stats);
+// Barramento travado (SDA preso em 0): as transferências bloqueantes e as
+// da DMA esperam até ele ser solto; i2c_write_timeout_us() desiste no prazo.
+// Cinco pulsos de SCL com os pinos como GPIO terminam o byte do escravo e o
+// soltam.
+void sim_i2c_hold(uint port, bool stuck);
+
+// Flash: começa apagada ou com a imagem do arquivo (que pode não existir
+// ainda); sim_flash_save() grava a imagem de volta no fim da simulação
+bool sim_flash_load(const char *path);
+void sim_flash_save(void);
+void sim_flash_get_stats(uint32_t *erases, uint32_t *pages);
+
+// Trocas de clk_sys e tempo passado abaixo do clock padrão
+void sim_clock_get_stats(uint32_t *changes, uint64_t *reduced_us);
+
+// --- Display SSD1306 decodificado do tráfego I2C (sim_ssd1306.c) ---
+
+typedef struct {
+  uint8_t ram[SIM_SSD1306_PAGES][SIM_SSD1306_WIDTH]; // GDDRAM
+  bool display_on;
+  bool inverted;
+  uint8_t contrast;
+  uint8_t addressing_mode; // 0 horizontal, 1 vertical, 2 página
+  uint8_t col_start, col_end, col;
+  uint8_t page_start, page_end, page;
+  // Estado do decodificador dentro de uma transação
+  bool in_transaction;
+  bool expect_control;
+  bool control_single; // Co = 1: só o próximo byte vale para este controle
+  bool data_mode;      // D/C# = 1
+  uint8_t command[8];
+  uint8_t command_len;
+  // Rolagem horizontal (0x26/0x27): páginas, sentido, quadros por passo e
+  // passos já aplicados à GDDRAM desde que foi ligada (0x2F)
+  bool scroll_left;
+  uint8_t scroll_first, scroll_last;
+  uint16_t scroll_frames;
+  bool scroll_active;
+  uint64_t scroll_since_us;
+  uint32_t scroll_steps;
+} sim_ssd1306_t;
+
+sim_ssd1306_t *sim_ssd1306_get(uint port);
+void sim_ssd1306_start(sim_ssd1306_t *d);
+void sim_ssd1306_byte(sim_ssd1306_t *d, uint8_t byte);
+void sim_ssd1306_stop(sim_ssd1306_t *d);
+bool sim_ssd1306_pixel(const sim_ssd1306_t *d, uint x, uint y);
+void sim_ssd1306_print(sim_ssd1306_t *d, FILE *out);
+
+#endif
@@ -0,0 +1,221 @@
+#include "sim.h"
+#include <string.h>
+
+// Decodifica o tráfego I2C de um SSD1306 (byte de controle + comandos ou
+// dados) para uma cópia da GDDRAM, seguindo o modo de endereçamento e a
+// janela de colunas/páginas configurados pelo firmware.
+//
+// A rolagem horizontal gira a GDDRAM no ritmo dos quadros do painel, pelo
+// relógio virtual: quantas colunas andaram depende de quanto tempo ela
+// ficou ligada, como no controlador.
+
+// Quadro do painel com o clock de ssd1306_config() (0xD5 0x80, pré-carga
+// 0xF1): ~370 kHz / (66 DCLK x 64 linhas) = ~88 Hz
+#define SIM_SSD1306_FRAME_US 11400
+
+// Quadros por passo de rolagem, pelo código de 3 bits do intervalo
+static const uint16_t scroll_frames[8] = { 5, 64, 128, 256, 3, 4, 25, 2 };
+
+static sim_ssd1306_t displays[2];
+
+sim_ssd1306_t *sim_ssd1306_get(uint port) {
+  sim_ssd1306_t *d = &displays[port & 1];
+  static bool initialized[2];
+  if (!initialized[port & 1]) {
+    // Valores do reset do controlador
+    memset(d, 0, sizeof(*d));
+    d->contrast = 0x7F;
+    d->addressing_mode = 2;
+    d->col_end = SIM_SSD1306_WIDTH - 1;
+    d->page_end = SIM_SSD1306_PAGES - 1;
+    initialized[port & 1] = true;
+  }
+  return d;
+}
+
+// Quantidade de bytes de argumento de cada comando
+static uint8_t sim_ssd1306_args(uint8_t cmd) {
+  switch (cmd) {
+    case 0x20: // Modo de endereçamento
+    case 0x81: // Contraste
+    case 0x8D: // Charge pump
+    case 0xA8: // Multiplex
+    case 0xD3: // Deslocamento vertical
+    case 0xD5: // Clock
+    case 0xD9: // Pré-carga
+    case 0xDA: // Pinos COM
+    case 0xDB: // VCOMH
+      return 1;
+    case 0x21: // Janela de colunas
+    case 0x22: // Janela de páginas
+    case 0xA3: // Área de rolagem vertical
+      return 2;
+    case 0x29: // Rolagem vertical + horizontal
+    case 0x2A:
+      return 5;
+    case 0x26: // Rolagem horizontal
+    case 0x27:
+      return 6;
+    default:
+      return 0;
+  }
+}
+
+// Aplica à GDDRAM os passos de rolagem vencidos até agora
+static void sim_ssd1306_scroll_sync(sim_ssd1306_t *d) {
+  if (!d->scroll_active)
+    return;
+  uint64_t step_us = (uint64_t)d->scroll_frames * SIM_SSD1306_FRAME_US;
+  uint32_t steps = (uint32_t)((sim_now_us() - d->scroll_since_us) / step_us);
+  for (; d->scroll_steps < steps; ++d->scroll_steps) {
+    for (uint page = d->scroll_first; page <= d->scroll_last && page < SIM_SSD1306_PAGES; ++page) {
+      uint8_t *row = d->ram[page];
+      if (d->scroll_left) {
+        uint8_t first = row[0];
+        memmove(row, row + 1, SIM_SSD1306_WIDTH - 1);
+        row[SIM_SSD1306_WIDTH - 1] = first;
+      } else {
+        uint8_t last = row[SIM_SSD1306_WIDTH - 1];
+        memmove(row + 1, row, SIM_SSD1306_WIDTH - 1);
+        row[0] = last;
+      }
+    }
+  }
+}
+
+static void sim_ssd1306_execute(sim_ssd1306_t *d) {
+  const uint8_t *c = d->command;
+  switch (c[0]) {
+    case 0x20:
+      d->addressing_mode = c[1] & 0x03;
+      break;
+    case 0x21:
+      d->col_start = d->col = c[1] & 0x7F;
+      d->col_end = c[2] & 0x7F;
+      break;
+    case 0x22:
+      d->page_start = d->page = c[1] & 0x07;
+      d->page_end = c[2] & 0x07;
+      break;
+    case 0x26:
+    case 0x27:
+      d->scroll_left = c[0] & 0x01;
+      d->scroll_first = c[2] & 0x07;
+      d->scroll_frames = scroll_frames[c[3] & 0x07];
+      d->scroll_last = c[4] & 0x07;
+      break;
+    case 0x2E:
+      sim_ssd1306_scroll_sync(d);
+      d->scroll_active = false;
+      break;
+    case 0x2F:
+      d->scroll_active = true;
+      d->scroll_since_us = sim_now_us();
+      d->scroll_steps = 0;
+      break;
+    case 0x81:
+      d->contrast = c[1];
+      break;
+    case 0xA6:
+    case 0xA7:
+      d->inverted = c[0] & 0x01;
+      break;
+    case 0xAE:
+    case 0xAF:
+      d->display_on = c[0] & 0x01;
+      break;
+    default:
+      if (c[0] >= 0xB0 && c[0] <= 0xB7) {
+        d->page = c[0] & 0x07; // Página no modo de endereçamento por página
+      } else if (c[0] <= 0x0F) {
+        d->col = (d->col & 0xF0) | c[0];
+      } else if (c[0] <= 0x1F) {
+        d->col = (uint8_t)(((c[0] & 0x07) << 4) | (d->col & 0x0F));
+      }
+      break;
+  }
+}
+
+static void sim_ssd1306_data(sim_ssd1306_t *d, uint8_t byte) {
+  sim_ssd1306_scroll_sync(d);
+  d->ram[d->page & 0x07][d->col & 0x7F] = byte;
+  switch (d->addressing_mode) {
+    case 0: // Horizontal
+      if (d->col++ >= d->col_end) {
+        d->col = d->col_start;
+        d->page = d->page >= d->page_end ? d->page_start : d->page + 1;
+      }
+      break;
+    case 1: // Vertical
+      if (d->page++ >= d->page_end) {
+        d->page = d->page_start;
+        d->col = d->col >= d->col_end ? d->col_start : d->col + 1;
+      }
+      break;
+    default: // Página: a coluna volta ao início da linha, sem trocar de página
+      d->col = (d->col + 1) & 0x7F;
+      break;
+  }
+}
+
+void sim_ssd1306_start(sim_ssd1306_t *d) {
+  d->in_transaction = true;
+  d->expect_control = true;
+  d->command_len = 0;
+}
+
+void sim_ssd1306_byte(sim_ssd1306_t *d, uint8_t byte) {
+  if (d->expect_control) {
+    d->control_single = byte & 0x80;
+    d->data_mode = byte & 0x40;
+    d->expect_control = false;
+    return;
+  }
+
+  if (d->data_mode) {
+    sim_ssd1306_data(d, byte);
+  } else {
+    d->command[d->command_len++] = byte;
+    if (d->command_len > sim_ssd1306_args(d->command[0])) {
+      sim_ssd1306_execute(d);
+      d->command_len = 0;
+    }
+  }
+  if (d->control_single)
+    d->expect_control = true;
+}
+
+void sim_ssd1306_stop(sim_ssd1306_t *d) {
+  d->in_transaction = false;
+  d->command_len = 0;
+}
+
+bool sim_ssd1306_pixel(const sim_ssd1306_t *d, uint x, uint y) {
+  bool on = (d->ram[y >> 3][x] >> (y & 7)) & 1;
+  return on != d->inverted;
+}
+
+// Duas linhas de pixels por linha de texto, com meios-blocos
+void sim_ssd1306_print(sim_ssd1306_t *d, FILE *out) {
+  static const char *const blocks[4] = { " ", "▀", "▄", "█" };
+
+  sim_ssd1306_scroll_sync(d);
+  if (!d->display_on) {
+    fputs("(display desligado)\n", out);
+    return;
+  }
+  fputc('+', out);
+  for (uint x = 0; x < SIM_SSD1306_WIDTH; ++x)
+    fputc('-', out);
+  fputs("+\n", out);
+  for (uint y = 0; y < SIM_SSD1306_PAGES * 8; y += 2) {
+    fputc('|', out);
+    for (uint x = 0; x < SIM_SSD1306_WIDTH; ++x)
+      fputs(blocks[sim_ssd1306_pixel(d, x, y) | sim_ssd1306_pixel(d, x, y + 1) << 1], out);
+    fputs("|\n", out);
+  }
+  fputc('+', out);
+  for (uint x = 0; x < SIM_SSD1306_WIDTH; ++x)
+    fputc('-', out);
+  fputs("+\n", out);
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include "lib/telemetry.h"
+
+// Converte a telemetria binária da serial (lib/telemetry.h) em CSV.
+//
+//   telemetria_csv [captura.bin] > treino.csv
+//   projeto_final_embarcatech_host roteiro.txt | telemetria_csv > treino.csv
+//
+// Sem arquivo, lê da entrada padrão. Trechos entre delimitadores que não
+// formam um registro válido (texto de comandos, bytes corrompidos) são
+// descartados e contados na saída de erro.
+
+#define TAMANHO_MAX_TRECHO 64
+
+static unsigned registros;
+static unsigned descartados;
+
+static void imprimir_decimos(unsigned valor) {
+  printf("%u.%u", valor / 10, valor % 10);
+}
+
+static void processar_trecho(const uint8_t *trecho, size_t tamanho) {
+  telemetry_record_t r;
+  if (!telemetry_decode(trecho, tamanho, &r)) {
+    ++descartados;
+    return;
+  }
+  ++registros;
+  printf("%lu,%u,%lu,%u,", (unsigned long)r.timestamp_ms, r.lane, (unsigned long)r.tick, r.screen);
+  imprimir_decimos(r.speed);
+  putchar(',');
+  imprimir_decimos(r.incline);
+  printf(",%lu.%03lu,%u,%d,%d,%d\n", (unsigned long)(r.distance_mm / 1000),
+         (unsigned long)(r.distance_mm % 1000), r.elapsed_s, (r.flags & TELEMETRY_FLAG_RUNNING) != 0,
+         (r.flags & TELEMETRY_FLAG_PAUSED) != 0, (r.flags & TELEMETRY_FLAG_EMERGENCY) != 0);
+}
+
+int main(int argc, char **argv) {
+  FILE *entrada = stdin;
+  if (argc == 2) {
+    entrada = fopen(argv[1], "rb");
+    if (!entrada) {
+      perror(argv[1]);
+      return 1;
+    }
+  } else if (argc > 2) {
+    fprintf(stderr, "uso: %s [captura]\n", argv[0]);
+    return 2;
+  }
+
+  printf("instante_ms,esteira,tick,tela,velocidade_kmh,inclinacao_pct,distancia_m,tempo_s,"
+         "em_andamento,pausado,emergencia\n");
+
+  uint8_t trecho[TAMANHO_MAX_TRECHO];
+  size_t tamanho = 0;
+  bool longo = false; // O trecho atual passou do tamanho máximo: é lixo
+  int c;
+  while ((c = fgetc(entrada)) != EOF) {
+    if (c != 0) {
+      if (tamanho < sizeof(trecho))
+        trecho[tamanho++] = (uint8_t)c;
+      else
+        longo = true;
+      continue;
+    }
+    if (longo)
+      ++descartados;
+    else if (tamanho > 0)
+      processar_trecho(trecho, tamanho);
+    tamanho = 0;
+    longo = false;
+  }
+  if (tamanho > 0 || longo)
+    ++descartados; // Quadro cortado no fim da captura
+
+  fprintf(stderr, "%u registros, %u trechos descartados\n", registros, descartados);
+  if (entrada != stdin)
+    fclose(entrada);
+  return 0;
+}
@@ -0,0 +1,235 @@
+#include "adc_stream.h"
+#include "hotpath.h"
+#include <string.h>
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#define ADC_CLOCK_HZ 48000000u
+
+typedef struct {
+  uint32_t acc;            // Soma das amostras do bloco de decimação atual
+  uint16_t acc_count;
+  uint32_t iir;            // Estado do IIR em Q8
+  uint16_t median[ADC_STREAM_MEDIAN_SIZE];
+  uint8_t median_fill;
+  uint8_t median_pos;
+  bool valid;
+  uint16_t value;          // Última saída filtrada
+  uint64_t timestamp_us;
+} adc_stream_input_t;
+
+static uint16_t ring[ADC_STREAM_RING_SAMPLES] __attribute__((aligned(ADC_STREAM_RING_SAMPLES * sizeof(uint16_t))));
+
+static adc_stream_config_t config;
+static adc_stream_input_t inputs[ADC_STREAM_INPUTS];
+static uint8_t order[ADC_STREAM_INPUTS]; // Sequência do round-robin
+static uint8_t order_count;
+static int dma_a = -1, dma_b = -1;
+static volatile uint32_t laps;           // Voltas completas no buffer circular
+static uint64_t consumed;                // Índice absoluto da próxima amostra a processar
+static uint64_t start_us;
+static uint32_t total_rate_hz;
+static uint32_t overruns;
+static bool running;
+
+static void HOT_FUNC(adc_stream_dma_irq_handler)(void) {
+  if (dma_channel_get_irq1_status(dma_a)) {
+    dma_channel_acknowledge_irq1(dma_a);
+    ++laps;
+  }
+  if (dma_channel_get_irq1_status(dma_b)) {
+    dma_channel_acknowledge_irq1(dma_b);
+    ++laps;
+  }
+}
+
+// Índice absoluto da próxima amostra que a DMA vai escrever.
+// O canal A escreve as voltas pares e o B as ímpares; se a paridade de laps
+// não bate com o canal ativo, a IRQ da volta que acabou ainda está pendente.
+static uint64_t HOT_FUNC(adc_stream_produced)(void) {
+  uint32_t lap = laps;
+  bool a_active = dma_channel_is_busy(dma_a);
+  uint ch = a_active ? dma_a : dma_b;
+  uint32_t pos = ((uintptr_t)dma_channel_hw_addr(ch)->write_addr - (uintptr_t)ring) / sizeof(uint16_t);
+  pos &= ADC_STREAM_RING_SAMPLES - 1;
+  if ((lap & 1) != (a_active ? 0u : 1u))
+    ++lap;
+  return (uint64_t)lap * ADC_STREAM_RING_SAMPLES + pos;
+}
+
+static uint16_t HOT_FUNC(adc_stream_median)(const adc_stream_input_t *in) {
+  uint16_t sorted[ADC_STREAM_MEDIAN_SIZE];
+  uint8_t n = in->median_fill;
+  memcpy(sorted, in->median, n * sizeof(uint16_t));
+  for (uint8_t i = 1; i < n; ++i) {
+    uint16_t v = sorted[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      --j;
+    }
+    sorted[j + 1] = v;
+  }
+  return sorted[n / 2];
+}
+
+static void HOT_FUNC(adc_stream_output)(adc_stream_input_t *in, uint16_t sample, uint64_t timestamp_us) {
+  switch (config.filter) {
+    case ADC_FILTER_IIR:
+      if (!in->valid)
+        in->iir = (uint32_t)sample << 8;
+      else
+        in->iir = in->iir + (((int32_t)((uint32_t)sample << 8) - (int32_t)in->iir) >> config.iir_shift);
+      in->value = (in->iir + 0x80) >> 8;
+      break;
+    case ADC_FILTER_MEDIAN:
+      in->median[in->median_pos] = sample;
+      in->median_pos = (in->median_pos + 1) % ADC_STREAM_MEDIAN_SIZE;
+      if (in->median_fill < ADC_STREAM_MEDIAN_SIZE)
+        ++in->median_fill;
+      in->value = adc_stream_median(in);
+      break;
+    default:
+      in->value = sample;
+      break;
+  }
+  in->timestamp_us = timestamp_us;
+  in->valid = true;
+}
+
+void HOT_FUNC(adc_stream_update)(void) {
+  if (!running)
+    return;
+
+  uint64_t produced = adc_stream_produced();
+  if (produced - consumed > ADC_STREAM_RING_SAMPLES) {
+    // O leitor ficou mais de uma volta atrás: descarta o que foi sobrescrito,
+    // mantendo o alinhamento com a sequência do round-robin
+    ++overruns;
+    uint64_t skip = produced - ADC_STREAM_RING_SAMPLES / 2 - consumed;
+    consumed += skip - skip % order_count;
+  }
+
+  uint16_t block = 1u << config.oversample_log2;
+  for (; consumed < produced; ++consumed) {
+    uint16_t sample = ring[consumed & (ADC_STREAM_RING_SAMPLES - 1)] & 0x0FFF;
+    adc_stream_input_t *in = &inputs[order[consumed % order_count]];
+    in->acc += sample;
+    if (++in->acc_count < block)
+      continue;
+
+    uint16_t decimated = (in->acc + (block >> 1)) >> config.oversample_log2;
+    in->acc = 0;
+    in->acc_count = 0;
+    adc_stream_output(in, decimated, start_us + consumed * 1000000u / total_rate_hz);
+  }
+}
+
+bool HOT_FUNC(adc_stream_read)(uint input, uint16_t *value, uint64_t *timestamp_us) {
+  if (input >= ADC_STREAM_INPUTS)
+    return false;
+  adc_stream_update();
+  const adc_stream_input_t *in = &inputs[input];
+  if (!in->valid)
+    return false;
+  *value = in->value;
+  if (timestamp_us)
+    *timestamp_us = in->timestamp_us;
+  return true;
+}
+
+uint32_t adc_stream_overruns(void) {
+  return overruns;
+}
+
+static void adc_stream_configure_dma(uint ch, uint chain_to, bool trigger) {
+  dma_channel_config c = dma_channel_get_default_config(ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, true);
+  channel_config_set_ring(&c, true, __builtin_ctz(sizeof(ring)));
+  channel_config_set_dreq(&c, DREQ_ADC);
+  channel_config_set_chain_to(&c, chain_to);
+  dma_channel_configure(ch, &c, ring, &adc_hw->fifo, ADC_STREAM_RING_SAMPLES, trigger);
+  dma_channel_set_irq1_enabled(ch, true);
+}
+
+// Recomeça o fluxo no início do buffer circular e da sequência do
+// round-robin; os valores filtrados das entradas continuam valendo
+static void adc_stream_start(void) {
+  for (uint8_t i = 0; i < ADC_STREAM_INPUTS; ++i) {
+    inputs[i].acc = 0;
+    inputs[i].acc_count = 0;
+  }
+  laps = 0;
+  consumed = 0;
+  adc_select_input(order[0]);
+  adc_stream_configure_dma(dma_b, dma_a, false);
+  adc_stream_configure_dma(dma_a, dma_b, true);
+
+  start_us = to_us_since_boot(get_absolute_time());
+  running = true;
+  adc_run(true);
+}
+
+bool adc_stream_init(const adc_stream_config_t *cfg) {
+  uint8_t mask = cfg->input_mask & ((1u << ADC_STREAM_INPUTS) - 1);
+  if (!mask || cfg->sample_rate_hz == 0)
+    return false;
+
+  config = *cfg;
+  memset(inputs, 0, sizeof(inputs));
+  order_count = 0;
+  for (uint8_t i = 0; i < ADC_STREAM_INPUTS; ++i)
+    if (mask & (1u << i))
+      order[order_count++] = i;
+
+  total_rate_hz = cfg->sample_rate_hz * order_count;
+  float div = (float)ADC_CLOCK_HZ / total_rate_hz - 1.0f;
+  if (div < 96.0f)
+    return false; // Acima de 500 kS/s no total
+
+  dma_a = dma_claim_unused_channel(false);
+  dma_b = dma_claim_unused_channel(false);
+  if (dma_a < 0 || dma_b < 0) {
+    if (dma_a >= 0) dma_channel_unclaim(dma_a);
+    if (dma_b >= 0) dma_channel_unclaim(dma_b);
+    dma_a = dma_b = -1;
+    return false;
+  }
+
+  adc_run(false);
+  adc_fifo_drain();
+  adc_set_round_robin(mask);
+  adc_fifo_setup(true, true, 1, false, false);
+  adc_set_clkdiv(div);
+
+  overruns = 0;
+  irq_add_shared_handler(DMA_IRQ_1, adc_stream_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_1, true);
+  adc_stream_start();
+  return true;
+}
+
+void adc_stream_stop(void) {
+  if (!running)
+    return;
+
+  running = false;
+  adc_run(false);
+  adc_fifo_drain(); // Espera a conversão em curso
+  dma_channel_set_irq1_enabled(dma_a, false);
+  dma_channel_set_irq1_enabled(dma_b, false);
+  // Aborta os dois: abortar um canal encadeado pode disparar o outro
+  dma_channel_abort(dma_a);
+  dma_channel_abort(dma_b);
+  dma_channel_acknowledge_irq1(dma_a);
+  dma_channel_acknowledge_irq1(dma_b);
+}
+
+void adc_stream_restart(void) {
+  if (dma_a < 0 || running)
+    return;
+  adc_stream_start();
+}
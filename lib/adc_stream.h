@@ -0,0 +1,44 @@
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include "pico/stdlib.h"
+
+// Captura contínua do ADC em round-robin, sem intervenção da CPU.
+//
+// O ADC converte as entradas selecionadas em sequência e o FIFO é esvaziado
+// por dois canais DMA encadeados (ping-pong) num buffer circular. A CPU só
+// trabalha quando alguém consulta os valores: adc_stream_update() percorre
+// as amostras novas, faz a sobreamostragem/decimação por entrada e aplica o
+// filtro configurado. Cada valor lido vem com o instante da última amostra
+// que o compôs, derivado da posição da amostra no fluxo.
+//
+// adc_stream_stop() para o ADC, a DMA e as suas interrupções (no repouso,
+// por exemplo); enquanto isso as leituras devolvem os últimos valores.
+// adc_stream_restart() recomeça o fluxo do início do buffer.
+
+#define ADC_STREAM_INPUTS 4
+#define ADC_STREAM_RING_SAMPLES 2048 // Potência de 2; 4 KB alinhados ao tamanho
+#define ADC_STREAM_MEDIAN_SIZE 5
+
+typedef enum {
+  ADC_FILTER_NONE,
+  ADC_FILTER_IIR,     // y += (x - y) / 2^iir_shift
+  ADC_FILTER_MEDIAN   // Mediana das últimas ADC_STREAM_MEDIAN_SIZE saídas decimadas
+} adc_stream_filter_t;
+
+typedef struct {
+  uint8_t input_mask;        // Bit n = entrada ADC n (GPIO 26 + n)
+  uint32_t sample_rate_hz;   // Taxa de amostragem por entrada
+  uint8_t oversample_log2;   // Cada saída é a média de 2^n amostras
+  adc_stream_filter_t filter;
+  uint8_t iir_shift;
+} adc_stream_config_t;
+
+bool adc_stream_init(const adc_stream_config_t *config);
+void adc_stream_stop(void);
+void adc_stream_restart(void);
+void adc_stream_update(void);
+bool adc_stream_read(uint input, uint16_t *value, uint64_t *timestamp_us);
+uint32_t adc_stream_overruns(void);
+
+#endif
@@ -0,0 +1,60 @@
+#include "boot_profile.h"
+#include <stdio.h>
+
+#if BOOT_PROFILE_ENABLED
+
+typedef struct {
+  uint32_t end_us;
+  uint32_t total_us;
+  uint8_t core;
+  bool marked;
+} boot_phase_record_t;
+
+static boot_phase_record_t phases[BOOT_PHASE_COUNT];
+static uint32_t last_mark_us[2]; // Por núcleo; o do núcleo 0 começa no reset
+
+static const char *const phase_names[BOOT_PHASE_COUNT] = {
+  [BOOT_RUNTIME] = "runtime",
+  [BOOT_STDIO] = "stdio",
+  [BOOT_ADC] = "adc",
+  [BOOT_GPIO] = "gpio",
+  [BOOT_RECORDER] = "recorder",
+  [BOOT_CORE1_LAUNCH] = "core1_launch",
+  [BOOT_RESUME] = "resume",
+  [BOOT_CONTROL] = "control",
+  [BOOT_I2C] = "i2c",
+  [BOOT_SSD1306_CONFIG] = "ssd1306_config",
+  [BOOT_FIRST_FRAME] = "first_frame",
+};
+
+void boot_profile_begin(void) {
+  last_mark_us[get_core_num()] = time_us_32();
+}
+
+void boot_profile_mark(boot_phase_t phase) {
+  uint32_t now = time_us_32();
+  uint core = get_core_num();
+  boot_phase_record_t *p = &phases[phase];
+  p->total_us += now - last_mark_us[core];
+  p->end_us = now;
+  p->core = (uint8_t)core;
+  p->marked = true;
+  last_mark_us[core] = now;
+}
+
+void boot_profile_print(void) {
+  printf("fase,nucleo,fim_us,duracao_us\n");
+  for (uint phase = 0; phase < BOOT_PHASE_COUNT; ++phase) {
+    const boot_phase_record_t *p = &phases[phase];
+    if (p->marked)
+      printf("%s,%u,%lu,%lu\n", phase_names[phase], p->core, (unsigned long)p->end_us, (unsigned long)p->total_us);
+  }
+}
+
+#else
+
+void boot_profile_print(void) {
+  printf("Perfil do boot desligado (cmake -DEMBARCATECH_PERFIL_BOOT=ON)\n");
+}
+
+#endif
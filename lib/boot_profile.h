@@ -0,0 +1,61 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include "pico/stdlib.h"
+
+// Perfil do boot: quanto cada fase da inicialização leva, do reset ao
+// primeiro quadro no display.
+//
+// Cada núcleo marca o fim das suas fases com boot_profile_mark(); a duração
+// conta desde a marca anterior do mesmo núcleo (no núcleo 0, desde o reset,
+// pelo timer do RP2040, que começa a contar com ele; no núcleo 1, desde
+// boot_profile_begin()). Uma fase marcada mais de uma vez (uma por esteira,
+// por exemplo) soma as durações e guarda o último fim. boot_profile_begin()
+// também tira da conta um trecho que não é boot, como a reprodução de um
+// rastro.
+//
+// Cada fase tem um único escritor, o núcleo que a executa; o núcleo 1 só
+// imprime depois que o núcleo 0 avisa, pela fila de mensagens, que marcou a
+// última fase dele.
+//
+// Com BOOT_PROFILE_ENABLED = 0 (o padrão; cmake -DEMBARCATECH_PERFIL_BOOT=ON
+// liga) as marcas somem.
+
+#ifndef BOOT_PROFILE_ENABLED
+#define BOOT_PROFILE_ENABLED 0
+#endif
+
+typedef enum {
+  BOOT_RUNTIME,        // Do reset ao main(): boot ROM, crt0 e runtime do SDK (núcleo 0)
+  BOOT_STDIO,          // stdio_init_all(): UART e USB (núcleo 0)
+  BOOT_ADC,            // adc_init() e a captura contínua por DMA (núcleo 0)
+  BOOT_GPIO,           // Pinos, PWM, padrões e botões das esteiras (núcleo 0)
+  BOOT_RECORDER,       // Filas, varredura da flash pelo gravador (núcleo 0)
+  BOOT_CORE1_LAUNCH,   // multicore_launch_core1() (núcleo 0)
+  BOOT_RESUME,         // Retomada dos treinos depois do watchdog (núcleo 0)
+  BOOT_CONTROL,        // Escalonador e watchdog, até o laço (núcleo 0)
+  BOOT_I2C,            // i2c_init() e pinos do barramento (núcleo 1)
+  BOOT_SSD1306_CONFIG, // ssd1306_config() (núcleo 1)
+  BOOT_FIRST_FRAME,    // Tela limpa enviada ao painel e DMA do envio (núcleo 1)
+  BOOT_PHASE_COUNT
+} boot_phase_t;
+
+#if BOOT_PROFILE_ENABLED
+
+void boot_profile_begin(void);
+void boot_profile_mark(boot_phase_t phase);
+
+#else
+
+static inline void boot_profile_begin(void) {}
+
+static inline void boot_profile_mark(boot_phase_t phase) {
+  (void)phase;
+}
+
+#endif
+
+// Imprime as fases em CSV: fase,nucleo,fim_us,duracao_us
+void boot_profile_print(void);
+
+#endif
@@ -0,0 +1,75 @@
+#include "estatistica.h"
+#include "hotpath.h"
+#include <string.h>
+
+void estatistica_iniciar(estatistica_t *e, uint16_t largura_faixa) {
+  memset(e, 0, sizeof(*e));
+  e->minimo = UINT16_MAX;
+  e->largura_faixa = largura_faixa ? largura_faixa : 1;
+}
+
+void HOT_FUNC(estatistica_adicionar)(estatistica_t *e, uint16_t valor, uint64_t dt_us) {
+  e->tempo_us += dt_us;
+  e->soma += (uint64_t)valor * dt_us;
+  e->soma_quadrados += (uint64_t)valor * valor * dt_us;
+  if (valor < e->minimo)
+    e->minimo = valor;
+  if (valor > e->maximo)
+    e->maximo = valor;
+  e->amostras++;
+
+  uint faixa = valor / e->largura_faixa;
+  if (faixa >= ESTATISTICA_FAIXAS)
+    faixa = ESTATISTICA_FAIXAS - 1;
+  e->faixas_us[faixa] += dt_us;
+}
+
+uint16_t HOT_FUNC(estatistica_media)(const estatistica_t *e) {
+  if (e->tempo_us == 0)
+    return 0;
+  return (uint16_t)((e->soma + e->tempo_us / 2) / e->tempo_us);
+}
+
+// Raiz quadrada inteira (piso), bit a bit
+static uint32_t raiz_inteira(uint64_t x) {
+  uint64_t resultado = 0;
+  uint64_t bit = 1ull << 62;
+  while (bit > x)
+    bit >>= 2;
+  while (bit) {
+    if (x >= resultado + bit) {
+      x -= resultado + bit;
+      resultado = (resultado >> 1) + bit;
+    } else {
+      resultado >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)resultado;
+}
+
+uint16_t estatistica_desvio(const estatistica_t *e) {
+  if (e->tempo_us == 0)
+    return 0;
+  // Var = E[x²] - E[x]², com 8 bits de fração (Q8)
+  uint64_t media_q8 = (e->soma << 8) / e->tempo_us;
+  uint64_t quadrados_q8 = (e->soma_quadrados << 8) / e->tempo_us;
+  uint64_t media2_q8 = (media_q8 * media_q8) >> 8;
+  uint64_t variancia_q8 = quadrados_q8 > media2_q8 ? quadrados_q8 - media2_q8 : 0;
+  // √(Q16) = Q8; arredonda para a unidade
+  return (uint16_t)((raiz_inteira(variancia_q8 << 8) + 128) >> 8);
+}
+
+uint16_t estatistica_minimo(const estatistica_t *e) {
+  return e->amostras ? e->minimo : 0;
+}
+
+uint16_t estatistica_maximo(const estatistica_t *e) {
+  return e->maximo;
+}
+
+uint32_t estatistica_faixa_s(const estatistica_t *e, uint faixa) {
+  if (faixa >= ESTATISTICA_FAIXAS)
+    return 0;
+  return (uint32_t)((e->faixas_us[faixa] + 500000) / 1000000);
+}
@@ -0,0 +1,43 @@
+#ifndef ESTATISTICA_H
+#define ESTATISTICA_H
+
+#include "pico/stdlib.h"
+
+// Estatística de uma grandeza ponderada pelo tempo, em memória constante.
+//
+// Cada amostra vale pelo intervalo que representa (dt em µs), de modo que a
+// média não depende do ritmo do loop: um tick atrasado por um beep ou pelo
+// I2C pesa mais, um tick adiantado pesa menos.
+//
+// Em vez do Welford em ponto flutuante, os momentos são somas inteiras
+// exatas (Σdt, Σx·dt, Σx²·dt): sem arredondamento não há cancelamento a
+// evitar, e a atualização não precisa de divisão (cara no Cortex-M0+).
+// Com valores até 300 (velocidade e inclinação ficam abaixo de 150) as
+// somas e a conta da variância cabem em 64 bits por mais de 24 horas.
+// A variância só é calculada na consulta.
+
+#define ESTATISTICA_FAIXAS 16 // A última faixa acumula tudo acima dela
+
+typedef struct {
+  uint64_t tempo_us;        // Σ dt
+  uint64_t soma;            // Σ x·dt
+  uint64_t soma_quadrados;  // Σ x²·dt
+  uint16_t minimo;
+  uint16_t maximo;
+  uint32_t amostras;
+  uint16_t largura_faixa;   // Largura de cada faixa do histograma
+  uint64_t faixas_us[ESTATISTICA_FAIXAS]; // Tempo passado em cada faixa
+} estatistica_t;
+
+void estatistica_iniciar(estatistica_t *e, uint16_t largura_faixa);
+void estatistica_adicionar(estatistica_t *e, uint16_t valor, uint64_t dt_us);
+
+// Média e desvio padrão ponderados pelo tempo, arredondados, na unidade dos valores
+uint16_t estatistica_media(const estatistica_t *e);
+uint16_t estatistica_desvio(const estatistica_t *e);
+uint16_t estatistica_minimo(const estatistica_t *e);
+uint16_t estatistica_maximo(const estatistica_t *e);
+// Tempo em segundos na faixa [i * largura, (i + 1) * largura)
+uint32_t estatistica_faixa_s(const estatistica_t *e, uint faixa);
+
+#endif
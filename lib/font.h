@@ -1,3 +1,5 @@
+#include "hotpath.h"
+
 // Fontes para A-Z e 0-9. Os caracteres tem 8x8 pixels
 static uint8_t font[] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Nada
@@ -68,4 +70,26 @@ static uint8_t font[] = {
     0x00, 0x00, 0x00, 0x80, 0x60, 0x00, 0x00, 0x00, // , (vírgula)
     0x00, 0x46, 0x26, 0x10, 0x08, 0x64, 0x62, 0x00, // % (porcentagem)
     0x00, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00, 0x00, // : (dois pontos)
-};
\ No newline at end of file
+};
+
+// Tabela de consulta caractere -> número do glifo em font[] (0 = não suportado).
+// Montada em tempo de compilação a partir da ordem dos glifos acima.
+#define FONT_GLYPH(c, n) [(uint8_t)(c)] = (n)
+#define FONT_GLYPH_SEQ5(c, n) \
+    FONT_GLYPH((c), (n)), FONT_GLYPH((c) + 1, (n) + 1), FONT_GLYPH((c) + 2, (n) + 2), \
+    FONT_GLYPH((c) + 3, (n) + 3), FONT_GLYPH((c) + 4, (n) + 4)
+#define FONT_GLYPH_SEQ10(c, n) FONT_GLYPH_SEQ5((c), (n)), FONT_GLYPH_SEQ5((c) + 5, (n) + 5)
+#define FONT_GLYPH_SEQ26(c, n) \
+    FONT_GLYPH_SEQ10((c), (n)), FONT_GLYPH_SEQ10((c) + 10, (n) + 10), \
+    FONT_GLYPH_SEQ5((c) + 20, (n) + 20), FONT_GLYPH((c) + 25, (n) + 25)
+
+static const uint8_t HOT_DATA(font_glyph)[256] = {
+    FONT_GLYPH_SEQ10('0', 1),  // 0-9
+    FONT_GLYPH_SEQ26('A', 11), // A-Z
+    FONT_GLYPH_SEQ26('a', 37), // a-z
+    FONT_GLYPH('.', 63),
+    FONT_GLYPH('/', 64),
+    FONT_GLYPH(',', 65),
+    FONT_GLYPH('%', 66),
+    FONT_GLYPH(':', 67),
+};
@@ -0,0 +1,104 @@
+#include "grafico.h"
+#include "hotpath.h"
+#include <string.h>
+#include "treino.h"
+
+#define GRAFICO_INTERVALO 0x00 // Código do datasheet: um passo a cada 5 quadros
+
+void grafico_reiniciar(grafico_t *g) {
+  memset(g, 0, sizeof(*g));
+  g->ultima = GRAFICO_COLUNAS - 1;
+  g->ultimo_segundo = -1;
+  g->pendentes = GRAFICO_COLUNAS;
+}
+
+// Altura em pixels acima do eixo, de 0 (no eixo) ao topo do gráfico
+static uint8_t HOT_FUNC(grafico_altura)(uint16_t valor, uint16_t maximo) {
+  if (valor >= maximo)
+    return GRAFICO_ALTURA - 1;
+  return (uint8_t)(valor * (GRAFICO_ALTURA - 1) / maximo);
+}
+
+void HOT_FUNC(grafico_amostrar)(grafico_t *g, int tempo_s, uint16_t velocidade, uint16_t inclinacao) {
+  if (tempo_s < g->ultimo_segundo)
+    grafico_reiniciar(g);
+  if (tempo_s - g->ultimo_segundo > GRAFICO_COLUNAS)
+    g->ultimo_segundo = tempo_s - GRAFICO_COLUNAS; // O que passou disso sai do gráfico
+
+  grafico_amostra_t amostra = {
+    grafico_altura(velocidade, TREINO_VELOCIDADE_MAX),
+    grafico_altura(inclinacao, TREINO_INCLINACAO_MAX),
+  };
+  while (g->ultimo_segundo < tempo_s) {
+    g->ultimo_segundo++;
+    g->ultima = (g->ultima + 1) % GRAFICO_COLUNAS;
+    g->amostras[g->ultima] = amostra;
+    if (g->quantidade < GRAFICO_COLUNAS)
+      g->quantidade++;
+    g->total++;
+    if (g->pendentes < GRAFICO_COLUNAS)
+      g->pendentes++;
+  }
+}
+
+static const grafico_amostra_t *HOT_FUNC(grafico_amostra)(const grafico_t *g, uint idade) {
+  return &g->amostras[(g->ultima + GRAFICO_COLUNAS - idade) % GRAFICO_COLUNAS];
+}
+
+// Linhas de..ate acima do eixo, como bits da coluna (bit 0 = topo do gráfico)
+static uint64_t HOT_FUNC(grafico_faixa)(uint8_t de, uint8_t ate) {
+  uint topo = GRAFICO_ALTURA - 1 - ate;
+  return ((1ull << (ate - de + 1)) - 1) << topo;
+}
+
+// Rasteriza a coluna da amostra com a idade dada (0 = a mais nova) direto
+// nos bytes de página: eixo, a velocidade ligada à amostra anterior por um
+// traço vertical e a inclinação pontilhada (segundos pares)
+static void HOT_FUNC(grafico_coluna)(ssd1306_t *ssd, const grafico_t *g, uint idade, uint8_t x) {
+  uint64_t bits = grafico_faixa(0, 0);
+  if (idade < g->quantidade) {
+    const grafico_amostra_t *a = grafico_amostra(g, idade);
+    const grafico_amostra_t *anterior = idade + 1 < g->quantidade ? grafico_amostra(g, idade + 1) : a;
+    if (a->velocidade < anterior->velocidade)
+      bits |= grafico_faixa(a->velocidade, anterior->velocidade);
+    else
+      bits |= grafico_faixa(anterior->velocidade, a->velocidade);
+    if ((g->total - 1 - idade) % 2 == 0)
+      bits |= grafico_faixa(a->inclinacao, a->inclinacao);
+  }
+
+  uint8_t bytes[GRAFICO_PAGINAS];
+  for (uint i = 0; i < GRAFICO_PAGINAS; ++i)
+    bytes[i] = (uint8_t)(bits >> (8 * i));
+  ssd1306_column(ssd, x, GRAFICO_PAGINA, bytes, GRAFICO_PAGINAS);
+}
+
+void HOT_FUNC(grafico_desenhar)(ssd1306_t *ssd, grafico_t *g) {
+  for (uint idade = 0; idade < GRAFICO_COLUNAS; ++idade)
+    grafico_coluna(ssd, g, idade, (uint8_t)(GRAFICO_COLUNAS - 1 - idade));
+  g->pendentes = 0;
+}
+
+// A parada é marcada para o meio do intervalo em que o painel com certeza
+// deu um único passo
+void grafico_rolar(ssd1306_t *ssd, grafico_t *g) {
+  ssd1306_scroll_start(ssd, true, GRAFICO_PAGINA, SSD1306_MAX_PAGES - 1, GRAFICO_INTERVALO);
+  uint32_t min_us, max_us;
+  ssd1306_scroll_window(ssd, 1, &min_us, &max_us);
+  g->rolando = true;
+  g->fim_rolagem = make_timeout_time_us(min_us + (max_us - min_us) / 2);
+}
+
+void grafico_concluir_rolagem(ssd1306_t *ssd, grafico_t *g) {
+  bool um_passo = ssd1306_scroll_stop(ssd, 1);
+  grafico_coluna(ssd, g, 0, GRAFICO_COLUNAS - 1);
+  if (um_passo) {
+    ssd1306_send_column(ssd, GRAFICO_COLUNAS - 1, GRAFICO_PAGINA, SSD1306_MAX_PAGES - 1);
+  } else {
+    // Parada atrasada (ou adiantada): o painel pode ter girado outro número
+    // de colunas, e as páginas do gráfico vão inteiras
+    ssd1306_send_pages(ssd, GRAFICO_PAGINA, SSD1306_MAX_PAGES - 1);
+  }
+  g->pendentes = 0;
+  g->rolando = false;
+}
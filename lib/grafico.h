@@ -0,0 +1,61 @@
+#ifndef GRAFICO_H
+#define GRAFICO_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Histórico de velocidade e inclinação dos últimos GRAFICO_COLUNAS segundos
+// de treino, uma coluna do display por segundo.
+//
+// As amostras ficam num anel de tamanho fixo, já convertidas em alturas do
+// gráfico. Redesenhar o gráfico inteiro a cada segundo mudaria quase todos
+// os bytes das páginas dele; em vez disso, a rolagem horizontal do
+// controlador desloca o gráfico uma coluna para a esquerda dentro do painel
+// e só a coluna nova (uma transação de GRAFICO_PAGINAS bytes) é enviada.
+//
+// A rolagem do SSD1306 é contínua: ela é ligada e desligada depois de um
+// passo. Com o clock de ssd1306_config() o quadro dura de 9,9 a 13,4 ms
+// (oscilador de 333 a 407 kHz, mais 5% de folga); com um passo a cada 5
+// quadros, o primeiro cai até 67 ms depois de ligada e o segundo não antes
+// de 89 ms. A parada é marcada para o meio desse intervalo e, até ela, nada
+// mais é enviado a esse display.
+//
+// ssd1306_scroll_stop() confere pelo tempo medido que o painel deu um único
+// passo. Uma parada fora do intervalo (o núcleo 1 atrasado pela flash, por
+// uma recuperação do I2C ou por listagens na serial) reenvia as páginas do
+// gráfico inteiras, e o painel volta a bater com a cópia dele.
+
+#define GRAFICO_COLUNAS 128                        // Segundos de histórico
+#define GRAFICO_PAGINA 1                           // A página 0 é o cabeçalho
+#define GRAFICO_PAGINAS (SSD1306_MAX_PAGES - GRAFICO_PAGINA)
+#define GRAFICO_ALTURA (GRAFICO_PAGINAS * 8)
+
+typedef struct {
+  uint8_t velocidade; // Altura em pixels acima do eixo
+  uint8_t inclinacao;
+} grafico_amostra_t;
+
+typedef struct {
+  grafico_amostra_t amostras[GRAFICO_COLUNAS]; // Anel; a mais nova em ultima
+  uint8_t ultima;
+  uint8_t quantidade;
+  uint32_t total;       // Amostras desde o início do treino (pontilhado da inclinação)
+  int ultimo_segundo;   // Tempo de treino da última amostra
+  uint8_t pendentes;    // Colunas ainda não desenhadas; mais de uma pede o gráfico inteiro
+  bool rolando;
+  absolute_time_t fim_rolagem;
+} grafico_t;
+
+void grafico_reiniciar(grafico_t *g);
+// Acrescenta uma amostra por segundo de treino desde a última; um tempo
+// menor que o da última amostra é um treino novo e limpa o histórico
+void grafico_amostrar(grafico_t *g, int tempo_s, uint16_t velocidade, uint16_t inclinacao);
+// Desenha todas as colunas no framebuffer (a mais nova na borda direita)
+void grafico_desenhar(ssd1306_t *ssd, grafico_t *g);
+// Liga a rolagem de uma coluna para a coluna pendente
+void grafico_rolar(ssd1306_t *ssd, grafico_t *g);
+// Desliga a rolagem e envia a coluna nova, na borda direita; as páginas do
+// gráfico inteiras se o painel pode ter dado outro número de passos
+void grafico_concluir_rolagem(ssd1306_t *ssd, grafico_t *g);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef HOTPATH_H
+#define HOTPATH_H
+
+#include "pico.h"
+
+// Caminho quente: desenho no framebuffer, montagem do envio ao display e o
+// passo de controle do núcleo 0.
+//
+// O firmware roda direto da flash QSPI pelo cache do XIP (16 KB): uma falta
+// no cache custa dezenas de ciclos e aparece como jitter nas tarefas e nas
+// sondas. Com HOTPATH_IN_RAM = 1 (cmake -DEMBARCATECH_CAMINHO_RAM=ON) as
+// funções marcadas com HOT_FUNC() e as tabelas marcadas com HOT_DATA() são
+// copiadas para a SRAM no boot (__time_critical_func(), seções
+// .time_critical.*); sem a opção, elas ficam na flash como o resto.
+//
+// As chamadas para o SDK (I2C, DMA, relógio) continuam na flash.
+
+#ifndef HOTPATH_IN_RAM
+#define HOTPATH_IN_RAM 0
+#endif
+
+#if HOTPATH_IN_RAM
+#define HOT_FUNC(f) __time_critical_func(f)
+#define HOT_DATA(name) __not_in_flash(#name) name
+#else
+#define HOT_FUNC(f) f
+#define HOT_DATA(name) name
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+#include "input.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+
+typedef struct {
+  input_button_config_t config;
+  volatile bool pressed;        // Estado estável (após debounce)
+  volatile uint32_t edge_ms;    // Instante da última borda vista pela IRQ
+  alarm_id_t debounce_alarm;
+  alarm_id_t hold_alarm;
+  bool repeating;
+} input_button_t;
+
+static input_button_t buttons[INPUT_MAX_BUTTONS];
+static uint8_t button_count;
+static int8_t gpio_to_button[NUM_BANK0_GPIOS];
+
+static input_event_t queue[INPUT_QUEUE_SIZE];
+static volatile uint32_t queue_head; // Escrito só pelo produtor
+static volatile uint32_t queue_tail; // Escrito só pelo consumidor
+static volatile uint32_t queue_dropped;
+
+static volatile uint32_t edge_count;   // Bordas vistas pela IRQ, antes do debounce
+static volatile uint32_t last_edge_us;
+
+static void input_push(uint8_t button, input_event_type_t type, uint32_t time_ms) {
+  uint32_t head = queue_head;
+  if (head - queue_tail >= INPUT_QUEUE_SIZE) {
+    ++queue_dropped;
+    return;
+  }
+  queue[head & (INPUT_QUEUE_SIZE - 1)] = (input_event_t){ button, type, time_ms };
+  __dmb(); // O evento precisa estar visível antes do novo head
+  queue_head = head + 1;
+  __sev(); // Acorda o loop principal se estiver em __wfe()
+}
+
+static int64_t input_hold_callback(alarm_id_t id, void *user_data) {
+  (void)id;
+  input_button_t *b = user_data;
+  uint8_t index = b - buttons;
+  if (!b->pressed) {
+    b->hold_alarm = 0;
+    return 0;
+  }
+
+  uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+  input_push(index, b->repeating ? INPUT_REPEAT : INPUT_LONG_PRESS, now_ms);
+  if (b->config.repeat_ms == 0) {
+    b->hold_alarm = 0;
+    return 0;
+  }
+  b->repeating = true;
+  return -(int64_t)b->config.repeat_ms * 1000; // Reagenda em relação ao disparo anterior
+}
+
+static int64_t input_debounce_callback(alarm_id_t id, void *user_data) {
+  (void)id;
+  input_button_t *b = user_data;
+  uint8_t index = b - buttons;
+  b->debounce_alarm = 0;
+
+  bool level = !gpio_get(b->config.gpio);
+  if (level == b->pressed)
+    return 0; // Bounce sem mudança de estado
+
+  b->pressed = level;
+  input_push(index, level ? INPUT_PRESS : INPUT_RELEASE, b->edge_ms);
+
+  if (b->hold_alarm) {
+    cancel_alarm(b->hold_alarm);
+    b->hold_alarm = 0;
+  }
+  if (level && b->config.long_press_ms) {
+    // O tempo de debounce já decorrido conta para o pressionamento longo
+    uint32_t elapsed = to_ms_since_boot(get_absolute_time()) - b->edge_ms;
+    uint32_t remaining = b->config.long_press_ms > elapsed ? b->config.long_press_ms - elapsed : 1;
+    b->repeating = false;
+    alarm_id_t alarm = add_alarm_in_ms(remaining, input_hold_callback, b, true);
+    b->hold_alarm = alarm > 0 ? alarm : 0;
+  }
+  return 0;
+}
+
+static void input_gpio_callback(uint gpio, uint32_t events) {
+  (void)events;
+  int8_t index = gpio < NUM_BANK0_GPIOS ? gpio_to_button[gpio] : -1;
+  if (index < 0)
+    return;
+
+  last_edge_us = time_us_32();
+  ++edge_count;
+
+  // Cada borda reinicia a janela de debounce desse botão
+  input_button_t *b = &buttons[index];
+  b->edge_ms = to_ms_since_boot(get_absolute_time());
+  if (b->debounce_alarm)
+    cancel_alarm(b->debounce_alarm);
+  alarm_id_t alarm = add_alarm_in_ms(b->config.debounce_ms, input_debounce_callback, b, true);
+  b->debounce_alarm = alarm > 0 ? alarm : 0;
+}
+
+bool input_init(const input_button_config_t *configs, uint8_t count) {
+  if (count > INPUT_MAX_BUTTONS)
+    return false;
+
+  for (uint i = 0; i < NUM_BANK0_GPIOS; ++i)
+    gpio_to_button[i] = -1;
+
+  button_count = count;
+  for (uint8_t i = 0; i < count; ++i) {
+    input_button_t *b = &buttons[i];
+    b->config = configs[i];
+    b->debounce_alarm = 0;
+    b->hold_alarm = 0;
+    b->repeating = false;
+    gpio_to_button[b->config.gpio] = i;
+
+    gpio_init(b->config.gpio);
+    gpio_set_dir(b->config.gpio, GPIO_IN);
+    gpio_pull_up(b->config.gpio);
+    b->pressed = !gpio_get(b->config.gpio);
+    b->edge_ms = to_ms_since_boot(get_absolute_time());
+
+    if (i == 0)
+      gpio_set_irq_enabled_with_callback(b->config.gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, input_gpio_callback);
+    else
+      gpio_set_irq_enabled(b->config.gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+  }
+  return true;
+}
+
+bool input_poll(input_event_t *event) {
+  uint32_t tail = queue_tail;
+  if (tail == queue_head)
+    return false;
+  __dmb();
+  *event = queue[tail & (INPUT_QUEUE_SIZE - 1)];
+  queue_tail = tail + 1;
+  return true;
+}
+
+bool input_is_pressed(uint8_t button) {
+  return button < button_count && buttons[button].pressed;
+}
+
+uint32_t input_dropped_events(void) {
+  return queue_dropped;
+}
+
+uint32_t input_edge_count(void) {
+  return edge_count;
+}
+
+uint32_t input_last_edge_us(void) {
+  return last_edge_us;
+}
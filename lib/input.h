@@ -0,0 +1,47 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "pico/stdlib.h"
+
+// Entrada de botões por interrupção de GPIO.
+//
+// Cada botão (ativo em nível baixo, com pull-up) tem sua própria máquina de
+// debounce: uma borda reinicia o alarme de debounce e, quando o nível fica
+// estável, o alarme gera PRESS/RELEASE. Um segundo alarme por botão gera
+// LONG_PRESS e, opcionalmente, REPEAT enquanto o botão segue pressionado.
+// Os eventos entram numa fila sem trava (produtor: interrupção do timer,
+// consumidor: loop principal) drenada com input_poll().
+
+#define INPUT_MAX_BUTTONS 8
+#define INPUT_QUEUE_SIZE 16 // Potência de 2
+
+typedef enum {
+  INPUT_PRESS,
+  INPUT_RELEASE,
+  INPUT_LONG_PRESS,
+  INPUT_REPEAT
+} input_event_type_t;
+
+typedef struct {
+  uint8_t button;     // Índice do botão em input_init()
+  uint8_t type;       // input_event_type_t
+  uint32_t time_ms;   // Instante da borda (PRESS/RELEASE) ou do disparo (LONG/REPEAT)
+} input_event_t;
+
+typedef struct {
+  uint gpio;
+  uint16_t debounce_ms;
+  uint16_t long_press_ms;  // 0 = sem LONG_PRESS
+  uint16_t repeat_ms;      // 0 = sem REPEAT após o LONG_PRESS
+} input_button_config_t;
+
+bool input_init(const input_button_config_t *buttons, uint8_t count);
+bool input_poll(input_event_t *event);
+bool input_is_pressed(uint8_t button);
+uint32_t input_dropped_events(void);
+// Bordas brutas (antes do debounce), para acordar de um sono sem esperar o
+// evento: o contador muda a cada borda e o instante vem de time_us_32()
+uint32_t input_edge_count(void);
+uint32_t input_last_edge_us(void);
+
+#endif
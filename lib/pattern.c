@@ -0,0 +1,171 @@
+#include "pattern.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+#define PATTERN_PWM_CLKDIV 64
+
+typedef struct {
+  uint gpio;
+  bool tone;
+  // Fila de padrões: escrita e lida com as interrupções desabilitadas
+  const pattern_t *queue[PATTERN_QUEUE_SIZE];
+  uint8_t head, tail;
+  // Padrão em execução (acessado só pelo callback enquanto active)
+  const pattern_t *current;
+  uint8_t step;
+  uint8_t round;
+  bool on_phase;
+  volatile bool active;
+  // Alarme em curso: gravado com as interrupções desabilitadas
+  alarm_id_t alarm;
+} pattern_channel_t;
+
+static pattern_channel_t channels[PATTERN_MAX_CHANNELS];
+static uint8_t channel_count;
+
+static void pattern_output(pattern_channel_t *ch, bool on, uint16_t tone_hz) {
+  if (!ch->tone) {
+    gpio_put(ch->gpio, on);
+    return;
+  }
+
+  uint slice = pwm_gpio_to_slice_num(ch->gpio);
+  if (!on || tone_hz == 0) {
+    pwm_set_gpio_level(ch->gpio, 0);
+    return;
+  }
+  // Recalcula a cada nota: o clock do sistema pode ter mudado
+  uint32_t tick_hz = clock_get_hz(clk_sys) / PATTERN_PWM_CLKDIV;
+  uint32_t wrap = tick_hz / tone_hz;
+  if (wrap > 0xFFFF)
+    wrap = 0xFFFF;
+  if (wrap < 2)
+    wrap = 2;
+  pwm_set_wrap(slice, wrap - 1);
+  pwm_set_gpio_level(ch->gpio, wrap / 2);
+}
+
+// Avança para o próximo padrão da fila; retorna false se a fila está vazia
+static bool pattern_next(pattern_channel_t *ch) {
+  if (ch->head == ch->tail) {
+    ch->current = NULL;
+    return false;
+  }
+  ch->current = ch->queue[ch->tail & (PATTERN_QUEUE_SIZE - 1)];
+  ++ch->tail;
+  ch->step = 0;
+  ch->round = 0;
+  ch->on_phase = false;
+  return true;
+}
+
+static int64_t pattern_alarm_callback(alarm_id_t id, void *user_data) {
+  (void)id;
+  pattern_channel_t *ch = user_data;
+
+  while (true) {
+    if (!ch->current && !pattern_next(ch)) {
+      pattern_output(ch, false, 0);
+      ch->active = false;
+      ch->alarm = 0;
+      return 0;
+    }
+
+    const pattern_t *p = ch->current;
+    if (!ch->on_phase) {
+      // Início de um passo: liga a saída pelo tempo on_ms
+      const pattern_step_t *s = &p->steps[ch->step];
+      ch->on_phase = true;
+      if (s->on_ms) {
+        pattern_output(ch, true, p->tone_hz);
+        return -(int64_t)s->on_ms * 1000;
+      }
+    }
+
+    // Fim da fase ligada: desliga e prepara o próximo passo
+    const pattern_step_t *s = &p->steps[ch->step];
+    pattern_output(ch, false, 0);
+    ch->on_phase = false;
+    if (++ch->step >= p->count) {
+      ch->step = 0;
+      if (p->repeat != PATTERN_FOREVER && ++ch->round >= p->repeat)
+        ch->current = NULL;
+    }
+    if (s->off_ms)
+      return -(int64_t)s->off_ms * 1000; // Relativo ao disparo anterior: sem deriva
+  }
+}
+
+int pattern_channel_init(uint gpio, bool tone) {
+  if (channel_count >= PATTERN_MAX_CHANNELS)
+    return -1;
+
+  pattern_channel_t *ch = &channels[channel_count];
+  ch->gpio = gpio;
+  ch->tone = tone;
+  ch->head = ch->tail = 0;
+  ch->current = NULL;
+  ch->active = false;
+  ch->alarm = 0;
+
+  if (tone) {
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv(&config, PATTERN_PWM_CLKDIV);
+    pwm_init(slice, &config, true);
+    pwm_set_gpio_level(gpio, 0);
+  } else {
+    gpio_init(gpio);
+    gpio_set_dir(gpio, GPIO_OUT);
+    gpio_put(gpio, 0);
+  }
+  return channel_count++;
+}
+
+bool pattern_play(int channel, const pattern_t *pattern) {
+  if (channel < 0 || channel >= channel_count || !pattern || pattern->count == 0)
+    return false;
+
+  pattern_channel_t *ch = &channels[channel];
+  bool queued = false;
+  uint32_t irq = save_and_disable_interrupts();
+  if ((uint8_t)(ch->head - ch->tail) < PATTERN_QUEUE_SIZE) {
+    ch->queue[ch->head & (PATTERN_QUEUE_SIZE - 1)] = pattern;
+    ++ch->head;
+    queued = true;
+  }
+  if (queued && !ch->active) {
+    // Arma e guarda o id sem o callback no meio: ele zera ch->alarm ao
+    // terminar, e pattern_stop() não pode cancelar um id que já venceu
+    ch->active = true;
+    alarm_id_t alarm = add_alarm_in_us(0, pattern_alarm_callback, ch, true);
+    ch->alarm = alarm > 0 ? alarm : 0;
+    if (alarm < 0)
+      ch->active = false;
+  }
+  restore_interrupts(irq);
+  return queued;
+}
+
+void pattern_stop(int channel) {
+  if (channel < 0 || channel >= channel_count)
+    return;
+
+  pattern_channel_t *ch = &channels[channel];
+  uint32_t irq = save_and_disable_interrupts();
+  if (ch->alarm)
+    cancel_alarm(ch->alarm);
+  ch->alarm = 0;
+  ch->tail = ch->head;
+  ch->current = NULL;
+  ch->active = false;
+  pattern_output(ch, false, 0);
+  restore_interrupts(irq);
+}
+
+bool pattern_busy(int channel) {
+  return channel >= 0 && channel < channel_count && channels[channel].active;
+}
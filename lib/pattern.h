@@ -0,0 +1,36 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "pico/stdlib.h"
+
+// Reprodutor de padrões de beep/pisca dirigido por alarmes do timer.
+//
+// Cada canal controla um GPIO: em modo digital o pino é ligado/desligado;
+// em modo tom o pino é um PWM com 50% de ciclo na frequência do padrão.
+// pattern_play() apenas enfileira o padrão e retorna; as transições
+// acontecem nos callbacks de alarme, sem nenhum sleep no chamador.
+// pattern_play() e pattern_stop() se protegem do callback desabilitando as
+// interrupções: chame-as no núcleo que atende os alarmes (o núcleo 0).
+
+#define PATTERN_MAX_CHANNELS 4
+#define PATTERN_QUEUE_SIZE 4 // Potência de 2
+#define PATTERN_FOREVER 0    // repeat = 0: repete até pattern_stop()
+
+typedef struct {
+  uint16_t on_ms;
+  uint16_t off_ms;
+} pattern_step_t;
+
+typedef struct {
+  const pattern_step_t *steps;
+  uint8_t count;
+  uint8_t repeat;    // Quantas vezes a sequência de passos é tocada
+  uint16_t tone_hz;  // Frequência nos canais de tom (ignorada nos digitais)
+} pattern_t;
+
+int pattern_channel_init(uint gpio, bool tone);
+bool pattern_play(int channel, const pattern_t *pattern);
+void pattern_stop(int channel);
+bool pattern_busy(int channel);
+
+#endif
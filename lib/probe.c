@@ -0,0 +1,71 @@
+#include "probe.h"
+#include <stdio.h>
+#include <string.h>
+
+static probe_t probes[PROBE_COUNT];
+
+static const char *const probe_names[PROBE_COUNT] = {
+  [PROBE_TICK] = "tick",
+  [PROBE_ADC] = "adc",
+  [PROBE_RENDER] = "render",
+  [PROBE_FLUSH] = "flush",
+  [PROBE_SEND_DATA] = "send_data",
+  [PROBE_RECORDER_FLUSH] = "recorder_flush",
+  [PROBE_WAKE] = "wake",
+};
+
+#if PROBE_ENABLED
+
+static void probe_clear(probe_t *p) {
+  memset(p, 0, sizeof(*p));
+  p->min_us = UINT32_MAX;
+}
+
+void probe_record(probe_id_t id, uint32_t start_us) {
+  uint32_t elapsed = time_us_32() - start_us;
+  probe_t *p = &probes[id];
+  if (p->reset_requested || p->count == 0)
+    probe_clear(p);
+
+  ++p->count;
+  p->sum_us += elapsed;
+  if (elapsed < p->min_us)
+    p->min_us = elapsed;
+  if (elapsed > p->max_us)
+    p->max_us = elapsed;
+
+  uint bucket = elapsed ? 32 - __builtin_clz(elapsed) : 0;
+  if (bucket >= PROBE_BUCKETS)
+    bucket = PROBE_BUCKETS - 1;
+  ++p->histogram[bucket];
+}
+
+#endif
+
+void probe_reset_all(void) {
+  for (uint id = 0; id < PROBE_COUNT; ++id)
+    probes[id].reset_requested = true;
+}
+
+void probe_print(void) {
+  printf("sonda,amostras,min_us,max_us,media_us,histograma_log2\n");
+  for (uint id = 0; id < PROBE_COUNT; ++id) {
+    // Cópia local: a sonda pode estar sendo atualizada pelo outro núcleo
+    probe_t p = probes[id];
+    if (p.reset_requested || p.count == 0) {
+      printf("%s,0,0,0,0,\n", probe_names[id]);
+      continue;
+    }
+
+    uint last = 0;
+    for (uint b = 0; b < PROBE_BUCKETS; ++b)
+      if (p.histogram[b])
+        last = b;
+
+    printf("%s,%lu,%lu,%lu,%lu,", probe_names[id], (unsigned long)p.count, (unsigned long)p.min_us,
+           (unsigned long)p.max_us, (unsigned long)(p.sum_us / p.count));
+    for (uint b = 0; b <= last; ++b)
+      printf(b ? ";%lu" : "%lu", (unsigned long)p.histogram[b]);
+    printf("\n");
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "pico/stdlib.h"
+
+// Sondas de latência dos trechos quentes do firmware.
+//
+// Cada sonda guarda, numa tabela estática, contagem, mínimo, máximo, soma e
+// um histograma log2 dos tempos em microssegundos (timer do RP2040, comum aos
+// dois núcleos). O balde 0 conta 0 µs e o balde i conta [2^(i-1), 2^i) µs.
+//
+// Cada sonda tem um único escritor (o núcleo que executa o trecho);
+// probe_reset_all() só pede a limpeza, feita pelo escritor na próxima
+// medição, para não disputar os contadores entre núcleos.
+//
+// Com PROBE_ENABLED = 0 (cmake -DEMBARCATECH_PROBES=OFF) as medições somem.
+
+#ifndef PROBE_ENABLED
+#define PROBE_ENABLED 1
+#endif
+
+#define PROBE_BUCKETS 24 // Último balde: 2^22 µs (~4 s) ou mais
+
+typedef enum {
+  PROBE_TICK,      // Passo da rampa: joystick, treino e amostra gravada (núcleo 0)
+  PROBE_ADC,       // Leitura de um eixo do joystick (núcleo 0)
+  PROBE_RENDER,    // Desenho de uma tela no framebuffer (núcleo 1)
+  PROBE_FLUSH,     // ssd1306_flush() / ssd1306_flush_async() (núcleo 1)
+  PROBE_SEND_DATA, // ssd1306_send_data(), quadro inteiro (núcleo 1)
+  PROBE_RECORDER_FLUSH, // Gravação de um setor do gravador na flash (núcleo 1)
+  PROBE_WAKE,      // Da borda do botão ao display religado, ao sair do sono (núcleo 1)
+  PROBE_COUNT
+} probe_id_t;
+
+typedef struct {
+  volatile bool reset_requested;
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  uint32_t histogram[PROBE_BUCKETS];
+} probe_t;
+
+#if PROBE_ENABLED
+
+static inline uint32_t probe_start(void) {
+  return time_us_32();
+}
+
+void probe_record(probe_id_t id, uint32_t start_us);
+
+#else
+
+static inline uint32_t probe_start(void) {
+  return 0;
+}
+
+static inline void probe_record(probe_id_t id, uint32_t start_us) {
+  (void)id;
+  (void)start_us;
+}
+
+#endif
+
+void probe_reset_all(void);
+// Imprime a tabela em CSV: sonda,amostras,min_us,max_us,media_us,histograma
+void probe_print(void);
+
+#endif
@@ -0,0 +1,277 @@
+#include "recorder.h"
+#include <string.h>
+#include "pico/flash.h"
+#include "pico/util/queue.h"
+#include "hardware/regs/addressmap.h"
+#include "hardware/sync.h"
+#include "probe.h"
+
+#define RECORDER_MAGIC 0x52545345u // "ESTR"
+#define RECORDER_FLASH_TIMEOUT_MS 1000
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;      // Cresce a cada setor aberto; o maior é o mais novo
+  uint32_t session[RECORDER_LANES]; // Sessão ativa de cada esteira quando o setor foi aberto (0 = nenhuma)
+} recorder_header_t;
+
+_Static_assert(sizeof(recorder_header_t) == 16, "cabeçalho do setor");
+
+#define RECORDER_RECORDS_PER_SECTOR \
+  ((FLASH_SECTOR_SIZE - sizeof(recorder_header_t)) / sizeof(recorder_record_t))
+
+static queue_t queue;
+static volatile uint32_t dropped;
+
+// Setor em preenchimento (núcleo 1)
+static uint8_t buffer[FLASH_SECTOR_SIZE] __attribute__((aligned(4)));
+static bool open;         // O buffer tem cabeçalho e corresponde a "sector"
+static uint records;      // Registros no buffer
+static uint programmed;   // Bytes do buffer já gravados na flash
+static bool erased;       // O setor já foi apagado nesta volta do anel
+static uint sector;       // Setor em preenchimento ou, fechado, o próximo a usar
+static uint32_t seq;
+static uint32_t sessions[RECORDER_LANES]; // Sessão aberta em cada esteira
+static uint32_t next_session = 1;
+
+typedef struct {
+  uint32_t offset;
+  const uint8_t *data;
+  size_t count;
+} recorder_flash_op_t;
+
+static const uint8_t *recorder_flash_sector(uint s) {
+  return (const uint8_t *)(XIP_BASE + RECORDER_FLASH_OFFSET + s * FLASH_SECTOR_SIZE);
+}
+
+// O buffer da RAM para o setor aberto, a flash para os demais
+static const uint8_t *recorder_sector_data(uint s) {
+  return (open && s == sector) ? buffer : recorder_flash_sector(s);
+}
+
+static const recorder_record_t *recorder_sector_records(const uint8_t *data) {
+  return (const recorder_record_t *)(data + sizeof(recorder_header_t));
+}
+
+static bool recorder_header_valid(const recorder_header_t *h) {
+  return h->magic == RECORDER_MAGIC;
+}
+
+// Setores de antes das esteiras têm 0xFFFFFFFF no lugar da segunda sessão
+static uint32_t recorder_header_session(const recorder_header_t *h, uint lane) {
+  return h->session[lane] == 0xFFFFFFFFu ? 0 : h->session[lane];
+}
+
+void recorder_init(void) {
+  queue_init(&queue, sizeof(recorder_record_t), RECORDER_QUEUE_SIZE);
+
+  // O setor com a maior sequência é o último gravado; o seguinte é o mais antigo
+  bool found = false;
+  uint newest = 0;
+  for (uint s = 0; s < RECORDER_SECTORS; ++s) {
+    const recorder_header_t *h = (const recorder_header_t *)recorder_flash_sector(s);
+    if (recorder_header_valid(h) && (!found || h->seq > seq)) {
+      found = true;
+      newest = s;
+      seq = h->seq;
+    }
+  }
+  if (!found)
+    return;
+
+  // Próximo número de sessão: maior sessão vista no setor mais novo + 1
+  const recorder_header_t *h = (const recorder_header_t *)recorder_flash_sector(newest);
+  uint32_t last = 0;
+  for (uint lane = 0; lane < RECORDER_LANES; ++lane)
+    if (recorder_header_session(h, lane) > last)
+      last = recorder_header_session(h, lane);
+  const recorder_record_t *r = recorder_sector_records((const uint8_t *)h);
+  for (uint i = 0; i < RECORDER_RECORDS_PER_SECTOR && r[i].kind != 0xFF; ++i)
+    if (r[i].kind == RECORDER_START && r[i].value > last)
+      last = r[i].value;
+  next_session = last + 1;
+  sector = (newest + 1) % RECORDER_SECTORS;
+  ++seq;
+}
+
+bool recorder_push(const recorder_record_t *record) {
+  if (record->lane >= RECORDER_LANES)
+    return false;
+  if (!queue_try_add(&queue, record)) {
+    ++dropped;
+    return false;
+  }
+  __sev(); // Acorda o núcleo 1
+  return true;
+}
+
+uint32_t recorder_dropped(void) {
+  return dropped;
+}
+
+static void recorder_flash_erase(void *param) {
+  const recorder_flash_op_t *op = param;
+  flash_range_erase(op->offset, op->count);
+}
+
+static void recorder_flash_program(void *param) {
+  const recorder_flash_op_t *op = param;
+  flash_range_program(op->offset, op->data, op->count);
+}
+
+void recorder_flush(void) {
+  if (!open)
+    return;
+
+  // Grava da página onde a última gravação parou até a página do último
+  // registro; a página parcial é regravada com os mesmos bytes no início,
+  // o que a NOR aceita (só leva bits de 1 para 0)
+  size_t used = sizeof(recorder_header_t) + records * sizeof(recorder_record_t);
+  size_t start = programmed / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+  size_t end = (used + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+  if (used == programmed)
+    return;
+
+  uint32_t probe = probe_start();
+  uint32_t offset = RECORDER_FLASH_OFFSET + sector * FLASH_SECTOR_SIZE;
+  if (!erased) {
+    recorder_flash_op_t op = { offset, NULL, FLASH_SECTOR_SIZE };
+    if (flash_safe_execute(recorder_flash_erase, &op, RECORDER_FLASH_TIMEOUT_MS) != PICO_OK)
+      return; // Tenta de novo na próxima chamada
+    erased = true;
+  }
+  recorder_flash_op_t op = { offset + start, buffer + start, end - start };
+  if (flash_safe_execute(recorder_flash_program, &op, RECORDER_FLASH_TIMEOUT_MS) == PICO_OK)
+    programmed = used;
+  probe_record(PROBE_RECORDER_FLUSH, probe);
+}
+
+static void recorder_open(void) {
+  memset(buffer, 0xFF, sizeof(buffer));
+  recorder_header_t h = { RECORDER_MAGIC, seq, { 0 } };
+  memcpy(h.session, sessions, sizeof(h.session));
+  memcpy(buffer, &h, sizeof(h));
+  open = true;
+  records = 0;
+  programmed = 0;
+  erased = false;
+}
+
+static void recorder_append(const recorder_record_t *record) {
+  if (!open)
+    recorder_open();
+
+  memcpy(buffer + sizeof(recorder_header_t) + records * sizeof(recorder_record_t), record,
+         sizeof(*record));
+  if (++records == RECORDER_RECORDS_PER_SECTOR) {
+    recorder_flush();
+    open = false;
+    sector = (sector + 1) % RECORDER_SECTORS;
+    ++seq;
+  }
+}
+
+void recorder_task(void) {
+  recorder_record_t r;
+  while (queue_try_remove(&queue, &r)) {
+    if (r.kind == RECORDER_START) {
+      r.value = next_session++;
+      sessions[r.lane] = r.value;
+    }
+    recorder_append(&r);
+    if (r.kind == RECORDER_SUMMARY) {
+      // Fim da sessão: o que ainda está na RAM vai para a flash
+      sessions[r.lane] = 0;
+      recorder_flush();
+    }
+  }
+}
+
+// Percorre os registros válidos, do setor mais antigo ao mais novo, com o
+// número da sessão a que cada um pertence
+typedef void (*recorder_visit_fn)(uint32_t session, const recorder_record_t *record, void *ctx);
+
+static void recorder_visit(recorder_visit_fn fn, void *ctx) {
+  uint first = open ? (sector + 1) % RECORDER_SECTORS : sector;
+  uint32_t current[RECORDER_LANES] = { 0 };
+  for (uint i = 0; i < RECORDER_SECTORS; ++i) {
+    uint s = (first + i) % RECORDER_SECTORS;
+    const uint8_t *data = recorder_sector_data(s);
+    const recorder_header_t *h = (const recorder_header_t *)data;
+    if (!recorder_header_valid(h))
+      continue;
+    // Vale o cabeçalho, caso o início da sessão já tenha sido sobrescrito
+    for (uint lane = 0; lane < RECORDER_LANES; ++lane)
+      current[lane] = recorder_header_session(h, lane);
+
+    const recorder_record_t *r = recorder_sector_records(data);
+    uint count = (data == buffer) ? records : RECORDER_RECORDS_PER_SECTOR;
+    for (uint k = 0; k < count && r[k].kind != 0xFF; ++k) {
+      uint lane = r[k].lane < RECORDER_LANES ? r[k].lane : 0;
+      if (r[k].kind == RECORDER_START)
+        current[lane] = r[k].value;
+      if (current[lane] != 0)
+        fn(current[lane], &r[k], ctx);
+      if (r[k].kind == RECORDER_SUMMARY)
+        current[lane] = 0;
+    }
+  }
+}
+
+// Uma sessão em montagem por esteira
+typedef struct {
+  recorder_session_fn fn;
+  void *ctx;
+  recorder_session_t sessions[RECORDER_LANES];
+} recorder_list_state_t;
+
+static void recorder_list_visit(uint32_t session, const recorder_record_t *record, void *ctx) {
+  recorder_list_state_t *st = ctx;
+  uint lane = record->lane < RECORDER_LANES ? record->lane : 0;
+  recorder_session_t *s = &st->sessions[lane];
+  if (session != s->id) {
+    if (s->id != 0)
+      st->fn(s, st->ctx);
+    memset(s, 0, sizeof(*s));
+    s->id = session;
+    s->lane = lane;
+  }
+  if (record->kind == RECORDER_SAMPLE && !s->complete) {
+    ++s->samples;
+    s->summary = *record;
+  } else if (record->kind == RECORDER_SUMMARY) {
+    s->complete = true;
+    s->summary = *record;
+    st->fn(s, st->ctx);
+    s->id = 0;
+  }
+}
+
+void recorder_list(recorder_session_fn fn, void *ctx) {
+  recorder_list_state_t st = { fn, ctx, { { 0 } } };
+  recorder_visit(recorder_list_visit, &st);
+  for (uint lane = 0; lane < RECORDER_LANES; ++lane)
+    if (st.sessions[lane].id != 0)
+      fn(&st.sessions[lane], ctx);
+}
+
+typedef struct {
+  uint32_t session;
+  recorder_record_fn fn;
+  void *ctx;
+  bool found;
+} recorder_stream_state_t;
+
+static void recorder_stream_visit(uint32_t session, const recorder_record_t *record, void *ctx) {
+  recorder_stream_state_t *st = ctx;
+  if (session == st->session) {
+    st->found = true;
+    st->fn(record, st->ctx);
+  }
+}
+
+bool recorder_stream(uint32_t session, recorder_record_fn fn, void *ctx) {
+  recorder_stream_state_t st = { session, fn, ctx, false };
+  recorder_visit(recorder_stream_visit, &st);
+  return st.found;
+}
@@ -0,0 +1,75 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+// Gravador das sessões de treino numa região reservada no fim da flash.
+//
+// A região é um anel de setores de 4 KB escritos em ordem (log-structured):
+// cada setor começa com um cabeçalho (número de sequência e sessão ativa) e
+// segue com registros de tamanho fixo. O setor em preenchimento fica na RAM
+// e só vai para a flash quando enche ou quando uma sessão termina; o próximo
+// setor do anel é sempre o mais antigo, então o desgaste se espalha por
+// todos igualmente.
+//
+// Cada registro traz a esteira (lane) que o gerou: sessões de esteiras
+// diferentes podem se intercalar no anel, e o cabeçalho do setor guarda a
+// sessão ativa de cada esteira.
+//
+// Divisão entre os núcleos:
+//   - recorder_push() (núcleo 0) só coloca o registro numa fila, sem travar;
+//     com a fila cheia o registro é descartado e contado;
+//   - recorder_task(), recorder_list() e recorder_stream() rodam no núcleo 1,
+//     dono do buffer e da flash. A gravação usa flash_safe_execute(), que
+//     segura o núcleo 0 em RAM enquanto a XIP está desligada (um apagamento
+//     e uma gravação de setor, ~50 ms, a cada ~340 registros).
+
+#ifndef RECORDER_SECTORS
+#define RECORDER_SECTORS 64 // 256 KB: ~3 horas de treino a 2 amostras/s
+#endif
+#define RECORDER_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - RECORDER_SECTORS * FLASH_SECTOR_SIZE)
+#define RECORDER_QUEUE_SIZE 32
+#define RECORDER_LANES 2 // Esteiras com sessão própria (cabem no cabeçalho do setor)
+
+typedef enum {
+  RECORDER_START = 1,   // Início de sessão (value = número da sessão)
+  RECORDER_SAMPLE = 2,  // Amostra de um tick (value = distância em mm)
+  RECORDER_SUMMARY = 3, // Resumo no fim da sessão: médias e distância total
+} recorder_kind_t;
+
+// Registro como gravado na flash (12 bytes)
+typedef struct {
+  uint8_t kind;      // recorder_kind_t; 0xFF = fim dos registros do setor
+  uint8_t lane;      // Esteira, 0..RECORDER_LANES-1
+  uint16_t elapsed_s;
+  uint16_t speed;    // 0,1 km/h (média no resumo)
+  uint16_t incline;  // 0,1 % (média no resumo)
+  uint32_t value;
+} recorder_record_t;
+
+typedef struct {
+  uint32_t id;
+  uint8_t lane;
+  uint32_t samples;
+  bool complete;     // Tem resumo (a sessão terminou e foi gravada inteira)
+  recorder_record_t summary; // Resumo ou, sem ele, a última amostra
+} recorder_session_t;
+
+typedef void (*recorder_session_fn)(const recorder_session_t *session, void *ctx);
+typedef void (*recorder_record_fn)(const recorder_record_t *record, void *ctx);
+
+// Lê os cabeçalhos da região e prepara a fila; chamar antes de lançar o núcleo 1
+void recorder_init(void);
+bool recorder_push(const recorder_record_t *record);
+// Núcleo 1: consome a fila e grava os setores que encheram
+void recorder_task(void);
+// Núcleo 1: grava o setor parcial (sem esperar encher)
+void recorder_flush(void);
+// Núcleo 1: percorre as sessões na ordem em que terminaram (as ainda abertas
+// por último), incluindo o que ainda está na RAM
+void recorder_list(recorder_session_fn fn, void *ctx);
+bool recorder_stream(uint32_t session, recorder_record_fn fn, void *ctx);
+uint32_t recorder_dropped(void);
+
+#endif
@@ -0,0 +1,118 @@
+#include "scheduler.h"
+#include "hotpath.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+
+typedef struct {
+  scheduler_task_config_t config;
+  bool enabled;
+  uint64_t release_us; // Liberação da ativação pendente; o prazo é release_us + período
+  scheduler_stats_t stats;
+} scheduler_task_t;
+
+static scheduler_task_t tasks[SCHEDULER_MAX_TASKS];
+static uint8_t task_count;
+static volatile bool reset_requested;
+
+bool scheduler_init(const scheduler_task_config_t *configs, uint8_t count) {
+  if (count > SCHEDULER_MAX_TASKS)
+    return false;
+
+  uint64_t now = time_us_64();
+  task_count = count;
+  for (uint i = 0; i < count; ++i) {
+    memset(&tasks[i], 0, sizeof(tasks[i]));
+    tasks[i].config = configs[i];
+    tasks[i].enabled = configs[i].enabled;
+    tasks[i].release_us = now;
+  }
+  return true;
+}
+
+void scheduler_set_enabled(uint8_t task, bool enabled) {
+  if (task >= task_count || tasks[task].enabled == enabled)
+    return;
+  tasks[task].enabled = enabled;
+  tasks[task].release_us = time_us_64();
+}
+
+// Próxima ativação; se até o prazo dela já passou, as ativações perdidas
+// são contadas e a fase recomeça agora, em vez de rodar a tarefa em rajada
+static void HOT_FUNC(scheduler_advance)(scheduler_task_t *t, uint64_t now) {
+  uint32_t period = t->config.period_us;
+  t->release_us += period;
+  if (now >= t->release_us + period) {
+    t->stats.misses += (uint32_t)((now - t->release_us) / period);
+    t->release_us = now;
+  }
+}
+
+void HOT_FUNC(scheduler_run_once)(void) {
+  if (reset_requested) {
+    reset_requested = false;
+    for (uint i = 0; i < task_count; ++i)
+      memset(&tasks[i].stats, 0, sizeof(tasks[i].stats));
+  }
+
+  uint64_t now = time_us_64();
+  scheduler_task_t *next = NULL;
+  uint64_t next_deadline = UINT64_MAX;
+  uint64_t wake_us = UINT64_MAX;
+  for (uint i = 0; i < task_count; ++i) {
+    scheduler_task_t *t = &tasks[i];
+    if (!t->enabled)
+      continue;
+    if (t->release_us > now) {
+      if (t->release_us < wake_us)
+        wake_us = t->release_us;
+      continue;
+    }
+    uint64_t deadline = t->release_us + t->config.period_us;
+    if (deadline < next_deadline) {
+      next_deadline = deadline;
+      next = t;
+    }
+  }
+
+  if (!next) {
+    // Nada liberado: dorme até a próxima liberação ou um evento
+    best_effort_wfe_or_timeout(wake_us == UINT64_MAX ? at_the_end_of_time : from_us_since_boot(wake_us));
+    return;
+  }
+
+  uint64_t release = next->release_us;
+  uint32_t jitter = (uint32_t)(now - release);
+  next->config.run();
+  uint64_t end = time_us_64();
+
+  scheduler_stats_t *s = &next->stats;
+  ++s->runs;
+  s->jitter_sum_us += jitter;
+  if (jitter > s->jitter_max_us)
+    s->jitter_max_us = jitter;
+  if (end - now > s->exec_max_us)
+    s->exec_max_us = (uint32_t)(end - now);
+  if (end > next_deadline)
+    ++s->misses;
+
+  // A tarefa pode ter se desligado (ou religado) durante a execução
+  if (next->enabled && next->release_us == release)
+    scheduler_advance(next, end);
+}
+
+void scheduler_reset_stats(void) {
+  reset_requested = true;
+  __sev(); // O núcleo do escalonador limpa ao acordar
+}
+
+void scheduler_print(void) {
+  printf("tarefa,periodo_us,execucoes,perdas,jitter_max_us,jitter_medio_us,exec_max_us\n");
+  for (uint i = 0; i < task_count; ++i) {
+    // Cópia local: os contadores podem estar sendo atualizados pelo outro núcleo
+    scheduler_stats_t s = tasks[i].stats;
+    printf("%s,%lu,%lu,%lu,%lu,%lu,%lu\n", tasks[i].config.name, (unsigned long)tasks[i].config.period_us,
+           (unsigned long)s.runs, (unsigned long)s.misses, (unsigned long)s.jitter_max_us,
+           (unsigned long)(s.runs ? s.jitter_sum_us / s.runs : 0), (unsigned long)s.exec_max_us);
+  }
+}
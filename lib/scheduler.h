@@ -0,0 +1,50 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "pico/stdlib.h"
+
+// Escalonador cooperativo de tarefas periódicas, sem tick.
+//
+// Cada tarefa tem seu período; a k-ésima ativação é liberada em
+// início + k·período e tem prazo no fim do mesmo período (prazo implícito).
+// Entre as tarefas liberadas roda a de prazo mais cedo (EDF); sem nenhuma
+// liberada o núcleo dorme em __wfe() até a próxima liberação, e qualquer
+// evento (IRQ, __sev) só faz o escalonador conferir os prazos de novo.
+//
+// As tarefas não são interrompidas: uma chamada que bloqueia atrasa as
+// outras, mas não muda o período de nenhuma. Por tarefa são contados os
+// prazos perdidos (término depois do prazo, ou ativações puladas por atraso
+// de mais de um período) e o jitter de início (início - liberação).
+//
+// Os contadores têm um único escritor (o núcleo que roda o escalonador);
+// scheduler_reset_stats() só pede a limpeza, como em probe.h.
+
+#define SCHEDULER_MAX_TASKS 8
+
+typedef struct {
+  const char *name;
+  uint32_t period_us;
+  void (*run)(void);
+  bool enabled; // Estado inicial; ver scheduler_set_enabled()
+} scheduler_task_config_t;
+
+typedef struct {
+  uint32_t runs;
+  uint32_t misses;
+  uint32_t jitter_max_us;
+  uint64_t jitter_sum_us;
+  uint32_t exec_max_us;
+} scheduler_stats_t;
+
+bool scheduler_init(const scheduler_task_config_t *tasks, uint8_t count);
+// Liga ou desliga uma tarefa; ao ser ligada ela é liberada imediatamente e
+// o período passa a contar daí
+void scheduler_set_enabled(uint8_t task, bool enabled);
+// Roda a tarefa liberada de prazo mais cedo ou dorme até a próxima liberação
+void scheduler_run_once(void);
+
+void scheduler_reset_stats(void);
+// Imprime a tabela em CSV: tarefa,periodo_us,execucoes,perdas,jitter_max_us,jitter_medio_us,exec_max_us
+void scheduler_print(void);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Seqlock para publicar estruturas de um único escritor para leitores em
+// outro núcleo sem travas: o escritor nunca espera; o leitor repete a cópia
+// se ela coincidiu com uma escrita (sequência ímpar ou alterada).
+
+typedef struct {
+  volatile uint32_t sequence;
+} seqlock_t;
+
+static inline void seqlock_write_begin(seqlock_t *lock) {
+  lock->sequence = lock->sequence + 1; // Ímpar: escrita em andamento
+  __dmb();
+}
+
+static inline void seqlock_write_end(seqlock_t *lock) {
+  __dmb();
+  lock->sequence = lock->sequence + 1;
+}
+
+static inline uint32_t seqlock_read_begin(const seqlock_t *lock) {
+  uint32_t sequence;
+  while ((sequence = lock->sequence) & 1)
+    tight_loop_contents();
+  __dmb();
+  return sequence;
+}
+
+// true se a cópia feita desde seqlock_read_begin() precisa ser refeita
+static inline bool seqlock_read_retry(const seqlock_t *lock, uint32_t sequence) {
+  __dmb();
+  return lock->sequence != sequence;
+}
+
+#endif
@@ -1,5 +1,37 @@
 #include "ssd1306.h"
+#include "hotpath.h"
 #include "font.h"
+#include "probe.h"
+#include <string.h>
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+// Velocidade de cada porta I2C (0 = não iniciada por ssd1306_bus_init())
+static uint bus_baudrate[2];
+
+// Clock do painel: divisor 1 com o oscilador na frequência de reset e
+// pré-carga de 1 + 15 DCLK; cada linha leva 1 + 15 + 50 DCLK
+#define SSD1306_CLK_DIV 0x80
+#define SSD1306_PRECHARGE 0xF1
+
+static const uint8_t ssd1306_config_commands[] = {
+  SET_DISP | 0x00,
+  SET_MEM_ADDR, 0x00, // Endereçamento horizontal: cada página é contígua no buffer
+  SET_DISP_START_LINE | 0x00,
+  SET_SEG_REMAP | 0x01,
+  SET_MUX_RATIO, HEIGHT - 1,
+  SET_COM_OUT_DIR | 0x08,
+  SET_DISP_OFFSET, 0x00,
+  SET_COM_PIN_CFG, 0x12,
+  SET_DISP_CLK_DIV, SSD1306_CLK_DIV,
+  SET_PRECHARGE, SSD1306_PRECHARGE,
+  SET_VCOM_DESEL, 0x30,
+  SET_CONTRAST, 0xFF,
+  SET_ENTIRE_ON,
+  SET_NORM_INV,
+  SET_CHARGE_PUMP, 0x14,
+  SET_DISP | 0x01,
+};
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -10,111 +42,713 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->bufsize = ssd->pages * ssd->width + 1;
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
+  ssd->sent_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->sent_buffer[0] = 0x40;
+  ssd->panel_synced = false;
   ssd->port_buffer[0] = 0x80;
+  ssd->dma_channel = -1;
+  ssd->tx_stream = NULL;
+  ssd->tx_capacity = 0;
+  ssd->flush_cb = NULL;
+  ssd->flush_ctx = NULL;
+  ssd->tx_bytes = 0;
+  ssd->scroll_left = false;
+  ssd->scroll_first = ssd->scroll_last = 0;
+  ssd->scroll_frames = 0;
+  ssd->scroll_on_us = ssd->scroll_on_end_us = 0;
+  ssd->contrast = 0xFF;
+  ssd->display_on = false;
+  ssd->sda = ssd->scl = SSD1306_NO_PIN;
+  ssd->bus_fault = false;
+  ssd->recover_at_us = 0;
+  ssd->dma_deadline_us = 0;
+  ssd->bus_errors = 0;
+  ssd->bus_recoveries = 0;
+  for (uint8_t page = 0; page < SSD1306_MAX_PAGES; ++page) {
+    ssd->dirty_x0[page] = 0xFF;
+    ssd->dirty_x1[page] = 0;
+  }
+}
+
+// Marca as colunas x0..x1 da página como alteradas desde o último flush
+static inline void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t page, uint8_t x0, uint8_t x1) {
+  if (x0 < ssd->dirty_x0[page])
+    ssd->dirty_x0[page] = x0;
+  if (x1 > ssd->dirty_x1[page])
+    ssd->dirty_x1[page] = x1;
+}
+
+static inline void ssd1306_clear_dirty(ssd1306_t *ssd) {
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    ssd->dirty_x0[page] = 0xFF;
+    ssd->dirty_x1[page] = 0;
+  }
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  ssd1306_command_list(ssd, ssd1306_config_commands, sizeof(ssd1306_config_commands));
+  ssd->contrast = 0xFF;
+  ssd->display_on = true;
+}
+
+uint ssd1306_bus_baudrate(const ssd1306_t *ssd) {
+  uint baudrate = bus_baudrate[i2c_hw_index(ssd->i2c_port)];
+  return baudrate ? baudrate : SSD1306_FAST_HZ;
+}
+
+// Prazo de uma transação de len bytes: o dobro do tempo no barramento (9
+// bits por byte, mais o endereço) e uma folga para o clock stretching
+static uint32_t ssd1306_timeout_us(const ssd1306_t *ssd, size_t len) {
+  return (uint32_t)((len + 1) * 9 * 2 * 1000000ull / ssd1306_bus_baudrate(ssd)) + SSD1306_TIMEOUT_MARGIN_US;
+}
+
+// Transação com prazo, contabilizada em tx_bytes; false sem resposta ou
+// com o prazo vencido
+static bool ssd1306_transfer(ssd1306_t *ssd, const uint8_t *src, size_t len) {
+  ssd->tx_bytes += len;
+  return i2c_write_timeout_us(ssd->i2c_port, ssd->address, src, len, false, ssd1306_timeout_us(ssd, len)) ==
+         (int)len;
+}
+
+// Marca o barramento em falha: o painel não reflete mais sent_buffer e a
+// próxima operação tenta a recuperação
+static void ssd1306_bus_fault(ssd1306_t *ssd) {
+  ssd->bus_errors++;
+  ssd->bus_fault = true;
+  ssd->panel_synced = false;
+  ssd->recover_at_us = time_us_32();
+}
+
+// Com o barramento em falha, tenta a recuperação quando chega a hora; false
+// enquanto ele não volta
+static bool ssd1306_bus_ready(ssd1306_t *ssd) {
+  if (!ssd->bus_fault)
+    return true;
+  if ((int32_t)(time_us_32() - ssd->recover_at_us) < 0)
+    return false;
+  return ssd1306_recover(ssd);
+}
+
+// Transação para o display; com o barramento em falha nada é enviado. false
+// se ela não foi entregue: uma sequência (janela e dados) para no primeiro
+// erro, sem escrever dados numa janela que o painel pode não ter recebido.
+static inline bool ssd1306_write(ssd1306_t *ssd, const uint8_t *src, size_t len) {
+  if (ssd->bus_fault)
+    return false;
+  if (!ssd1306_transfer(ssd, src, len)) {
+    ssd1306_bus_fault(ssd);
+    return false;
+  }
+  return true;
+}
+
+// Início de uma operação: espera o envio por DMA e, com o barramento em
+// falha, tenta a recuperação. Ela só acontece aqui, nunca entre as
+// transações de uma sequência.
+static bool ssd1306_begin(ssd1306_t *ssd) {
+  ssd1306_wait(ssd);
+  return ssd1306_bus_ready(ssd);
+}
+
+// Pinos do barramento como I2C, com pull-up
+static void ssd1306_bus_setup(ssd1306_t *ssd, uint baudrate) {
+  i2c_init(ssd->i2c_port, baudrate);
+  gpio_set_function(ssd->sda, GPIO_FUNC_I2C);
+  gpio_set_function(ssd->scl, GPIO_FUNC_I2C);
+  gpio_pull_up(ssd->sda);
+  gpio_pull_up(ssd->scl);
+}
+
+// Solta um escravo que segura o SDA no meio de um byte: os pinos viram GPIO
+// em dreno aberto (saída em 0 ou entrada com pull-up) e o SCL pulsa até o
+// SDA subir, no máximo 9 vezes (8 bits e o ACK); depois, um STOP.
+static void ssd1306_bus_clear(ssd1306_t *ssd) {
+  const uint half_period_us = 5; // 100 kHz
+  uint sda = ssd->sda, scl = ssd->scl;
+  gpio_init(sda);
+  gpio_init(scl);
+  gpio_pull_up(sda);
+  gpio_pull_up(scl);
+  busy_wait_us(half_period_us);
+  for (uint i = 0; i < 9 && !gpio_get(sda); ++i) {
+    gpio_set_dir(scl, GPIO_OUT);
+    busy_wait_us(half_period_us);
+    gpio_set_dir(scl, GPIO_IN);
+    busy_wait_us(half_period_us);
+  }
+  gpio_set_dir(scl, GPIO_OUT);
+  gpio_set_dir(sda, GPIO_OUT);
+  busy_wait_us(half_period_us);
+  gpio_set_dir(scl, GPIO_IN);
+  busy_wait_us(half_period_us);
+  gpio_set_dir(sda, GPIO_IN); // SDA sobe com o SCL alto: STOP
+  busy_wait_us(half_period_us);
+}
+
+// Algumas transações de NOP seguidas, todas com resposta
+static bool ssd1306_probe(ssd1306_t *ssd) {
+  const uint8_t nop[] = { 0x00, SET_NOP };
+  for (uint i = 0; i < SSD1306_PROBE_WRITES; ++i) {
+    if (!ssd1306_transfer(ssd, nop, sizeof(nop)))
+      return false;
+  }
+  return true;
+}
+
+uint ssd1306_bus_init(ssd1306_t *ssd, uint8_t sda, uint8_t scl) {
+  uint port = i2c_hw_index(ssd->i2c_port);
+  ssd->sda = sda;
+  ssd->scl = scl;
+  if (bus_baudrate[port] == 0) {
+    bus_baudrate[port] = SSD1306_FAST_PLUS_HZ;
+    ssd1306_bus_setup(ssd, bus_baudrate[port]);
+  }
+  if (bus_baudrate[port] > SSD1306_FAST_HZ && !ssd1306_probe(ssd)) {
+    // O byte interrompido pode ter deixado o painel segurando o SDA
+    ssd1306_bus_clear(ssd);
+    bus_baudrate[port] = SSD1306_FAST_HZ;
+    ssd1306_bus_setup(ssd, bus_baudrate[port]);
+  }
+  return bus_baudrate[port];
+}
+
+bool ssd1306_recover(ssd1306_t *ssd) {
+  if (ssd->dma_channel >= 0)
+    dma_channel_abort(ssd->dma_channel);
+  if (ssd->sda != SSD1306_NO_PIN) {
+    ssd1306_bus_clear(ssd);
+    ssd1306_bus_setup(ssd, ssd1306_bus_baudrate(ssd));
+  } else {
+    i2c_init(ssd->i2c_port, ssd1306_bus_baudrate(ssd));
+  }
+
+  // Rolagem parada, configuração e o estado de contraste e liga/desliga,
+  // numa transação: controle e 0x2E, a tabela, contraste (2) e 0xAE/0xAF
+  uint8_t commands[2 + sizeof(ssd1306_config_commands) + 3];
+  size_t count = 0;
+  commands[count++] = 0x00;
+  commands[count++] = SET_SCROLL_OFF;
+  memcpy(&commands[count], ssd1306_config_commands, sizeof(ssd1306_config_commands));
+  count += sizeof(ssd1306_config_commands);
+  commands[count++] = SET_CONTRAST;
+  commands[count++] = ssd->contrast;
+  commands[count++] = SET_DISP | (ssd->display_on ? 0x01 : 0x00);
+  if (!ssd1306_transfer(ssd, commands, count)) {
+    ssd->bus_errors++;
+    ssd->recover_at_us = time_us_32() + SSD1306_RECOVER_INTERVAL_US;
+    return false;
+  }
+  ssd->bus_fault = false;
+  ssd->panel_synced = false; // O próximo flush reenvia o quadro inteiro
+  ssd->bus_recoveries++;
+  return true;
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  if (!ssd1306_begin(ssd))
+    return;
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
-    false
-  );
+  ssd1306_write(ssd, ssd->port_buffer, 2);
+}
+
+// Uma sequência de comandos com um só byte de controle (Co = 0, D/C# = 0)
+// seguido dos bytes de comando. Listas maiores que SSD1306_MAX_COMMAND_LIST
+// vão em várias transações, cada uma com o seu byte de controle: o
+// controlador lê os comandos como um fluxo, então um comando de vários bytes
+// pode ficar dividido entre duas delas. false no primeiro erro.
+static bool ssd1306_write_commands(ssd1306_t *ssd, const uint8_t *commands, size_t count) {
+  uint8_t buffer[1 + SSD1306_MAX_COMMAND_LIST];
+  buffer[0] = 0x00;
+  while (count > 0) {
+    size_t chunk = count < SSD1306_MAX_COMMAND_LIST ? count : SSD1306_MAX_COMMAND_LIST;
+    memcpy(&buffer[1], commands, chunk);
+    if (!ssd1306_write(ssd, buffer, chunk + 1))
+      return false;
+    commands += chunk;
+    count -= chunk;
+  }
+  return true;
+}
+
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count) {
+  if (ssd1306_begin(ssd))
+    ssd1306_write_commands(ssd, commands, count);
+}
+
+// Janela de escrita (colunas x0..x1, páginas p0..p1) para o próximo envio de
+// dados, dentro de uma sequência já começada
+static inline bool ssd1306_set_window(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  const uint8_t window[] = { SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1 };
+  return ssd1306_write_commands(ssd, window, sizeof(window));
+}
+
+// Envia len bytes do framebuffer a partir de offset numa transação de dados:
+// o byte anterior ao trecho recebe temporariamente o byte de controle 0x40,
+// evitando um buffer auxiliar. O trecho só vai para a cópia do painel se a
+// transação foi entregue.
+static bool HOT_FUNC(ssd1306_write_span)(ssd1306_t *ssd, uint16_t offset, size_t len) {
+  uint8_t *span = &ssd->ram_buffer[offset];
+  uint8_t saved = span[-1];
+  span[-1] = 0x40;
+  bool sent = ssd1306_write(ssd, span - 1, len + 1);
+  span[-1] = saved;
+  if (sent)
+    memcpy(&ssd->sent_buffer[offset], span, len);
+  return sent;
+}
+
+void ssd1306_set_contrast(ssd1306_t *ssd, uint8_t contrast) {
+  const uint8_t commands[] = { SET_CONTRAST, contrast };
+  ssd1306_command_list(ssd, commands, sizeof(commands));
+  ssd->contrast = contrast;
+}
+
+void ssd1306_invert(ssd1306_t *ssd, bool invert) {
+  ssd1306_command(ssd, SET_NORM_INV | (invert ? 0x01 : 0x00));
+}
+
+void ssd1306_display_on(ssd1306_t *ssd, bool on) {
+  ssd1306_command(ssd, SET_DISP | (on ? 0x01 : 0x00));
+  ssd->display_on = on;
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
-}
-
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
+  if (!ssd1306_begin(ssd))
+    return; // As marcações ficam para depois da recuperação
+
+  uint32_t probe = probe_start();
+  if (ssd1306_set_window(ssd, 0, ssd->width - 1, 0, ssd->pages - 1) &&
+      ssd1306_write(ssd, ssd->ram_buffer, ssd->bufsize)) {
+    memcpy(ssd->sent_buffer + 1, ssd->ram_buffer + 1, ssd->bufsize - 1);
+    ssd->panel_synced = true;
+    ssd1306_clear_dirty(ssd);
+  }
+  probe_record(PROBE_SEND_DATA, probe);
+}
+
+// Retira a faixa suja da página e a reduz aos bytes que diferem do painel.
+// Retorna false quando não há nada a enviar nessa página.
+static bool HOT_FUNC(ssd1306_take_span)(ssd1306_t *ssd, uint8_t page, uint8_t *x0_out, uint8_t *x1_out) {
+  uint8_t x0 = ssd->dirty_x0[page];
+  uint8_t x1 = ssd->dirty_x1[page];
+  ssd->dirty_x0[page] = 0xFF;
+  ssd->dirty_x1[page] = 0;
+  if (x0 > x1)
+    return false;
+
+  uint16_t base = page * ssd->width + 1;
+  while (x0 < x1 && ssd->ram_buffer[base + x0] == ssd->sent_buffer[base + x0])
+    ++x0;
+  while (x1 > x0 && ssd->ram_buffer[base + x1] == ssd->sent_buffer[base + x1])
+    --x1;
+  if (x0 == x1 && ssd->ram_buffer[base + x0] == ssd->sent_buffer[base + x0])
+    return false;
+
+  *x0_out = x0;
+  *x1_out = x1;
+  return true;
+}
+
+// Envia apenas as colunas alteradas de cada página suja.
+void HOT_FUNC(ssd1306_flush)(ssd1306_t *ssd) {
+  if (!ssd1306_begin(ssd))
+    return; // As marcações ficam para depois da recuperação
+
+  uint32_t probe = probe_start();
+  if (!ssd->panel_synced) {
+    ssd1306_send_data(ssd);
+    probe_record(PROBE_FLUSH, probe);
+    return;
+  }
+
+  uint8_t x0, x1;
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    if (!ssd1306_take_span(ssd, page, &x0, &x1))
+      continue;
+
+    // Depois de um erro o painel está fora da cópia (panel_synced = false)
+    // e o próximo flush, já recuperado, reenvia o quadro inteiro
+    if (!ssd1306_set_window(ssd, x0, x1, page, page) ||
+        !ssd1306_write_span(ssd, page * ssd->width + 1 + x0, x1 - x0 + 1))
+      break;
+  }
+  probe_record(PROBE_FLUSH, probe);
+}
+
+// Quadros por passo de rolagem, pelo código de 3 bits do intervalo
+static const uint16_t ssd1306_scroll_frames[8] = { 5, 64, 128, 256, 3, 4, 25, 2 };
+
+void ssd1306_scroll_start(ssd1306_t *ssd, bool left, uint8_t first_page, uint8_t last_page, uint8_t interval) {
+  const uint8_t commands[] = {
+    left ? SET_SCROLL_LEFT : SET_SCROLL_RIGHT,
+    0x00, first_page, interval & 0x07, last_page, 0x00, 0xFF,
+    SET_SCROLL_ON,
+  };
+  ssd->scroll_on_us = time_us_32();
+  ssd1306_command_list(ssd, commands, sizeof(commands));
+  ssd->scroll_on_end_us = time_us_32();
+  ssd->scroll_left = left;
+  ssd->scroll_first = first_page;
+  ssd->scroll_last = last_page;
+  ssd->scroll_frames = ssd1306_scroll_frames[interval & 0x07];
+}
+
+// Faixa de duração do quadro, em µs: (divisor) x (DCLK por linha) x (linhas)
+// na faixa alargada do oscilador
+static void ssd1306_frame_us(const ssd1306_t *ssd, uint32_t *min_us, uint32_t *max_us) {
+  uint64_t dclk = (uint64_t)((SSD1306_CLK_DIV & 0x0F) + 1) *
+                  ((SSD1306_PRECHARGE & 0x0F) + (SSD1306_PRECHARGE >> 4) + 50) * ssd->height;
+  uint64_t fosc_max = (uint64_t)SSD1306_FOSC_MAX_HZ * (100 + SSD1306_FOSC_MARGIN_PCT) / 100;
+  uint64_t fosc_min = (uint64_t)SSD1306_FOSC_MIN_HZ * (100 - SSD1306_FOSC_MARGIN_PCT) / 100;
+  *min_us = (uint32_t)(dclk * 1000000u / fosc_max);
+  *max_us = (uint32_t)((dclk * 1000000u + fosc_min - 1) / fosc_min);
+}
+
+// O passo k (k >= 1) cai entre (k n - 1) quadros curtos e k n quadros longos
+void ssd1306_scroll_window(const ssd1306_t *ssd, uint8_t steps, uint32_t *min_us, uint32_t *max_us) {
+  uint32_t frame_min, frame_max;
+  ssd1306_frame_us(ssd, &frame_min, &frame_max);
+  uint32_t n = ssd->scroll_frames;
+  *min_us = steps * n * frame_max;
+  *max_us = ((steps + 1) * n - 1) * frame_min;
+}
+
+// Gira a linha de uma página em uma coluna, no sentido da rolagem
+static void ssd1306_rotate_row(uint8_t *row, uint8_t width, bool left) {
+  if (left) {
+    uint8_t first = row[0];
+    memmove(row, row + 1, width - 1);
+    row[width - 1] = first;
+  } else {
+    uint8_t last = row[width - 1];
+    memmove(row + 1, row, width - 1);
+    row[0] = last;
+  }
+}
+
+bool ssd1306_scroll_stop(ssd1306_t *ssd, uint8_t steps) {
+  uint32_t off_us = time_us_32();
+  ssd1306_command(ssd, SET_SCROLL_OFF);
+  uint32_t off_end_us = time_us_32();
+
+  // Ligada por pelo menos do fim da ativação ao início da parada e por no
+  // máximo do início de uma ao fim da outra
+  uint32_t window_min, window_max;
+  ssd1306_scroll_window(ssd, steps, &window_min, &window_max);
+  bool exact = off_us - ssd->scroll_on_end_us >= window_min && off_end_us - ssd->scroll_on_us < window_max;
+
+  for (uint8_t page = ssd->scroll_first; page <= ssd->scroll_last && page < ssd->pages; ++page) {
+    uint16_t base = page * ssd->width + 1;
+    for (uint8_t i = 0; i < steps; ++i) {
+      ssd1306_rotate_row(&ssd->ram_buffer[base], ssd->width, ssd->scroll_left);
+      ssd1306_rotate_row(&ssd->sent_buffer[base], ssd->width, ssd->scroll_left);
+    }
+    if (!exact) {
+      // O painel pode ter girado outro número de colunas: a página toda vai de novo
+      for (uint8_t x = 0; x < ssd->width; ++x)
+        ssd->sent_buffer[base + x] = ~ssd->ram_buffer[base + x];
+      ssd1306_mark_dirty(ssd, page, 0, ssd->width - 1);
+    } else if (steps > 0 && ssd->dirty_x0[page] <= ssd->dirty_x1[page]) {
+      // Uma faixa suja pendente girou junto: a página inteira é comparada
+      ssd1306_mark_dirty(ssd, page, 0, ssd->width - 1);
+    }
+  }
+  return exact;
+}
+
+void HOT_FUNC(ssd1306_column)(ssd1306_t *ssd, uint8_t x, uint8_t first_page, const uint8_t *bytes, uint8_t count) {
+  if (x >= ssd->width)
+    return;
+  for (uint8_t i = 0; i < count && first_page + i < ssd->pages; ++i) {
+    ssd->ram_buffer[(first_page + i) * ssd->width + 1 + x] = bytes[i];
+    ssd1306_mark_dirty(ssd, first_page + i, x, x);
+  }
+}
+
+// Páginas first..last inteiras numa transação de dados, como um trecho do flush
+bool ssd1306_send_pages(ssd1306_t *ssd, uint8_t first_page, uint8_t last_page) {
+  if (first_page >= ssd->pages || first_page > last_page)
+    return false;
+  if (last_page >= ssd->pages)
+    last_page = ssd->pages - 1;
+  if (!ssd1306_begin(ssd))
+    return false;
+
+  size_t len = (size_t)(last_page - first_page + 1) * ssd->width;
+  if (!ssd1306_set_window(ssd, 0, ssd->width - 1, first_page, last_page) ||
+      !ssd1306_write_span(ssd, first_page * ssd->width + 1, len))
+    return false;
+  for (uint8_t page = first_page; page <= last_page; ++page) {
+    ssd->dirty_x0[page] = 0xFF;
+    ssd->dirty_x1[page] = 0;
+  }
+  return true;
+}
+
+// No endereçamento horizontal, a janela de uma coluna faz os bytes descerem
+// de página em página: uma transação de dados para a coluna inteira.
+// Páginas além da última do display são ignoradas.
+bool ssd1306_send_column(ssd1306_t *ssd, uint8_t x, uint8_t first_page, uint8_t last_page) {
+  if (x >= ssd->width || first_page >= ssd->pages || first_page > last_page)
+    return false;
+  if (last_page >= ssd->pages)
+    last_page = ssd->pages - 1;
+  if (!ssd1306_begin(ssd))
+    return false;
+
+  uint8_t buffer[1 + SSD1306_MAX_PAGES];
+  uint8_t count = 0;
+  buffer[count++] = 0x40;
+  for (uint8_t page = first_page; page <= last_page; ++page)
+    buffer[count++] = ssd->ram_buffer[page * ssd->width + 1 + x];
+  if (!ssd1306_set_window(ssd, x, x, first_page, last_page) || !ssd1306_write(ssd, buffer, count))
+    return false;
+  for (uint8_t page = first_page; page <= last_page; ++page) {
+    uint16_t index = page * ssd->width + 1 + x;
+    ssd->sent_buffer[index] = ssd->ram_buffer[index];
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Envio assíncrono por DMA
+//
+// O quadro é convertido para o formato do registrador IC_DATA_CMD (um byte
+// por palavra de 16 bits, bit STOP no último byte de cada transação) em
+// tx_stream. A DMA alimenta o FIFO de TX do I2C a partir desse buffer, de
+// modo que ram_buffer fica livre para o próximo quadro assim que
+// ssd1306_flush_async() retorna.
+// ---------------------------------------------------------------------------
+
+static ssd1306_t *dma_owner[NUM_DMA_CHANNELS];
+
+static void HOT_FUNC(ssd1306_dma_irq_handler)(void) {
+  for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+    ssd1306_t *ssd = dma_owner[ch];
+    if (!ssd || !dma_channel_get_irq0_status(ch))
+      continue;
+    dma_channel_acknowledge_irq0(ch);
+    if (ssd->flush_cb)
+      ssd->flush_cb(ssd, ssd->flush_ctx);
+  }
+}
+
+bool ssd1306_dma_init(ssd1306_t *ssd) {
+  static bool irq_installed = false;
+
+  int ch = dma_claim_unused_channel(false);
+  if (ch < 0)
+    return false;
+
+  // Pior caso: todas as páginas sujas de ponta a ponta
+  ssd->tx_capacity = ssd->pages * (7 + 1 + ssd->width);
+  ssd->tx_stream = calloc(ssd->tx_capacity, sizeof(uint16_t));
+  if (!ssd->tx_stream) {
+    dma_channel_unclaim(ch);
+    return false;
+  }
+
+  dma_channel_config c = dma_channel_get_default_config(ch);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(ssd->i2c_port, true));
+  dma_channel_configure(ch, &c, &i2c_get_hw(ssd->i2c_port)->data_cmd, ssd->tx_stream, 0, false);
+
+  ssd->dma_channel = ch;
+  dma_owner[ch] = ssd;
+  dma_channel_set_irq0_enabled(ch, true);
+  if (!irq_installed) {
+    irq_add_shared_handler(DMA_IRQ_0, ssd1306_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    irq_installed = true;
+  }
+  return true;
+}
+
+void ssd1306_set_flush_callback(ssd1306_t *ssd, ssd1306_flush_cb_t cb, void *ctx) {
+  ssd->flush_ctx = ctx;
+  ssd->flush_cb = cb;
+}
+
+// Ocupado enquanto a DMA não terminou ou o FIFO do I2C ainda está esvaziando.
+// Um quadro que passa do prazo é abandonado e o barramento fica em falha.
+bool HOT_FUNC(ssd1306_busy)(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0)
+    return false;
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  bool busy = dma_channel_is_busy(ssd->dma_channel) || !(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+              (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS);
+  if (busy && !ssd->bus_fault && (int32_t)(time_us_32() - ssd->dma_deadline_us) >= 0) {
+    dma_channel_abort(ssd->dma_channel);
+    ssd1306_bus_fault(ssd);
+  }
+  return busy && !ssd->bus_fault;
+}
+
+void ssd1306_wait(ssd1306_t *ssd) {
+  while (ssd1306_busy(ssd))
+    tight_loop_contents();
+}
+
+// Mesma janela de ssd1306_set_window(), codificada como uma transação no stream
+static inline uint16_t *ssd1306_stream_window(uint16_t *out, uint8_t x0, uint8_t x1, uint8_t page) {
+  *out++ = 0x00;
+  *out++ = SET_COL_ADDR;
+  *out++ = x0;
+  *out++ = x1;
+  *out++ = SET_PAGE_ADDR;
+  *out++ = page;
+  *out++ = page | I2C_IC_DATA_CMD_STOP_BITS;
+  return out;
+}
+
+// Monta o quadro sujo em tx_stream e dispara a DMA.
+// Retorna false, sem consumir as marcações de sujeira, se o envio anterior
+// ainda estiver em andamento ou o barramento estiver em falha.
+bool HOT_FUNC(ssd1306_flush_async)(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0) {
+    ssd1306_flush(ssd);
+    return true;
+  }
+  if (ssd1306_busy(ssd))
+    return false;
+
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    // Envio anterior abortado (NAK): o painel não reflete mais sent_buffer
+    (void)hw->clr_tx_abrt;
+    ssd1306_bus_fault(ssd);
+  }
+  if (!ssd1306_bus_ready(ssd))
+    return false;
+
+  uint32_t probe = probe_start();
+  if (!ssd->panel_synced) {
+    // Invalida a cópia do painel para que o quadro inteiro seja reenviado
+    for (size_t i = 1; i < ssd->bufsize; ++i)
+      ssd->sent_buffer[i] = ~ssd->ram_buffer[i];
+    for (uint8_t page = 0; page < ssd->pages; ++page)
+      ssd1306_mark_dirty(ssd, page, 0, ssd->width - 1);
+    ssd->panel_synced = true;
+  }
+
+  uint16_t *out = ssd->tx_stream;
+  uint8_t x0, x1;
+  for (uint8_t page = 0; page < ssd->pages; ++page) {
+    if (!ssd1306_take_span(ssd, page, &x0, &x1))
+      continue;
+
+    out = ssd1306_stream_window(out, x0, x1, page);
+
+    uint16_t base = page * ssd->width + 1;
+    *out++ = 0x40;
+    for (uint8_t x = x0; x <= x1; ++x) {
+      uint8_t byte = ssd->ram_buffer[base + x];
+      ssd->sent_buffer[base + x] = byte;
+      *out++ = byte;
+    }
+    out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  }
+
+  size_t count = out - ssd->tx_stream;
+  if (count == 0) {
+    probe_record(PROBE_FLUSH, probe);
+    return true;
+  }
+
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+  ssd->tx_bytes += count;
+  ssd->dma_deadline_us = time_us_32() + ssd1306_timeout_us(ssd, count);
+  dma_channel_transfer_from_buffer_now(ssd->dma_channel, ssd->tx_stream, count);
+  probe_record(PROBE_FLUSH, probe);
+  return true;
+}
+
+void HOT_FUNC(ssd1306_pixel)(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+  uint16_t index = (y >> 3) * ssd->width + x + 1;
   uint8_t pixel = (y & 0b111);
+  ssd1306_mark_dirty(ssd, y >> 3, x, x);
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
   else
     ssd->ram_buffer[index] &= ~(1 << pixel);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+// Preenche o retângulo [x0, x1] x [y0, y1] trabalhando direto nos bytes de
+// página: cada página recebe uma máscara vertical e é aplicada a toda a
+// faixa de colunas de uma vez (memset quando a máscara cobre a página inteira).
+static void HOT_FUNC(ssd1306_fill_area)(ssd1306_t *ssd, int x0, int x1, int y0, int y1, bool value) {
+  if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+  if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 >= ssd->width) x1 = ssd->width - 1;
+  if (y1 >= ssd->height) y1 = ssd->height - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+  uint8_t first_page = y0 >> 3;
+  uint8_t last_page = y1 >> 3;
+  size_t len = x1 - x0 + 1;
+
+  for (uint8_t page = first_page; page <= last_page; ++page) {
+    uint8_t mask = 0xFF;
+    if (page == first_page)
+      mask &= 0xFF << (y0 & 7);
+    if (page == last_page)
+      mask &= 0xFF >> (7 - (y1 & 7));
+
+    uint8_t *row = &ssd->ram_buffer[page * ssd->width + 1 + x0];
+    if (mask == 0xFF) {
+      memset(row, value ? 0xFF : 0x00, len);
+    } else if (value) {
+      for (size_t i = 0; i < len; ++i)
+        row[i] |= mask;
+    } else {
+      mask = ~mask;
+      for (size_t i = 0; i < len; ++i)
+        row[i] &= mask;
     }
+    ssd1306_mark_dirty(ssd, page, x0, x1);
+  }
 }
 
+void HOT_FUNC(ssd1306_fill)(ssd1306_t *ssd, bool value) {
+  // O memset da biblioteca escreve palavras de 32 bits nos trechos alinhados
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
+  for (uint8_t page = 0; page < ssd->pages; ++page)
+    ssd1306_mark_dirty(ssd, page, 0, ssd->width - 1);
+}
 
+void HOT_FUNC(ssd1306_rect)(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  if (width == 0 || height == 0)
+    return;
 
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  int right = left + width - 1;
+  int bottom = top + height - 1;
 
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    ssd1306_fill_area(ssd, left, right, top, bottom, value);
+    return;
   }
+  ssd1306_fill_area(ssd, left, right, top, top, value);
+  ssd1306_fill_area(ssd, left, right, bottom, bottom, value);
+  ssd1306_fill_area(ssd, left, left, top, bottom, value);
+  ssd1306_fill_area(ssd, right, right, top, bottom, value);
 }
 
-void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+void HOT_FUNC(ssd1306_line)(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+    // Linhas horizontais e verticais vão direto para os bytes de página
+    if (y0 == y1 || x0 == x1) {
+        ssd1306_fill_area(ssd, x0, x1, y0, y1, value);
+        return;
+    }
+
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
 
@@ -143,59 +777,54 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 }
 
 
-void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+void HOT_FUNC(ssd1306_hline)(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+  ssd1306_fill_area(ssd, x0, x1, y, y, value);
 }
 
-void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+void HOT_FUNC(ssd1306_vline)(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+  ssd1306_fill_area(ssd, x, x, y0, y1, value);
 }
 
 // Função para desenhar um caractere
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+// Cada coluna de 8 pixels do glifo é escrita direto nos bytes de página
+// (opaca, como antes); com y fora do múltiplo de 8 ela se divide entre a
+// página de y e a seguinte.
+void HOT_FUNC(ssd1306_draw_char)(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
+  uint8_t glyph = font_glyph[(uint8_t)c];
+  if (glyph == 0 || x >= ssd->width || y >= ssd->height)
+    return; // Caractere não suportado ou fora da tela
 
-  if (c >= 'A' && c <= 'Z')
-  {
-    index = (c - 'A' + 11) * 8; // Para letras maiúsculas
-  }
-  else if (c >= 'a' && c <= 'z')
-  {
-    index = (c - 'a' + 37) * 8; // Para letras minúsculas
-  }
-  else if (c >= '0' && c <= '9')
+  const uint8_t *columns = &font[glyph * 8];
+  uint8_t count = (ssd->width - x < 8) ? ssd->width - x : 8;
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 7;
+  uint8_t *row = &ssd->ram_buffer[page * ssd->width + 1 + x];
+
+  if (shift == 0)
   {
-    index = (c - '0' + 1) * 8; // Para números
+    memcpy(row, columns, count);
   }
   else
   {
-    // Mapeamento de caracteres especiais
-    switch (c)
-    {
-      case '/': index = 64 * 8; break; // Barra
-      case ',': index = 65 * 8; break; // Vírgula
-      case '.': index = 63 * 8; break; // Ponto final
-      case ':': index = 67 * 8; break; // Dois pontos
-      case '%': index = 66 * 8; break; // Porcentagem
-      default: return; // Caractere não suportado
-    }
-  }
+    uint8_t mask = 0xFF << shift;
+    for (uint8_t i = 0; i < count; ++i)
+      row[i] = (row[i] & ~mask) | (uint8_t)(columns[i] << shift);
 
-  for (uint8_t i = 0; i < 8; ++i)
-  {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j)
+    if (page + 1 < ssd->pages)
     {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+      uint8_t *next = row + ssd->width;
+      uint8_t next_mask = 0xFF >> (8 - shift);
+      for (uint8_t i = 0; i < count; ++i)
+        next[i] = (next[i] & ~next_mask) | (columns[i] >> (8 - shift));
+      ssd1306_mark_dirty(ssd, page + 1, x, x + count - 1);
     }
   }
+  ssd1306_mark_dirty(ssd, page, x, x + count - 1);
 }
 
 // Função para desenhar uma string
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+void HOT_FUNC(ssd1306_draw_string)(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
 {
   while (*str)
   {
@@ -1,9 +1,36 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_MAX_PAGES (HEIGHT / 8)
+#define SSD1306_MAX_COMMAND_LIST 32
+
+// Barramento: Fast-mode Plus quando o painel responde nele, senão Fast-mode.
+// Toda transferência tem prazo; uma que falha (sem resposta ou prazo
+// vencido) interrompe a sequência em curso (janela e dados) e deixa o
+// barramento em falha. A próxima operação começa pela recuperação: até 9
+// pulsos de SCL por GPIO para soltar um escravo preso no meio de um byte,
+// STOP, I2C reiniciado e a configuração reenviada. Sem sucesso, a próxima
+// tentativa espera SSD1306_RECOVER_INTERVAL_US.
+#define SSD1306_FAST_PLUS_HZ 1000000
+#define SSD1306_FAST_HZ 400000
+#define SSD1306_PROBE_WRITES 4             // Transações de teste em cada velocidade
+#define SSD1306_TIMEOUT_MARGIN_US 1000     // Além do dobro do tempo no barramento
+#define SSD1306_RECOVER_INTERVAL_US 100000
+#define SSD1306_NO_PIN 0xFF
+
+// Oscilador interno na frequência de reset (0xD5 com nibble alto 8): 333 a
+// 407 kHz no datasheet, a 25 °C. A rolagem é medida com essa faixa alargada
+// em SSD1306_FOSC_MARGIN_PCT, para a temperatura, a tensão e a variação
+// entre painéis.
+#define SSD1306_FOSC_MIN_HZ 333000
+#define SSD1306_FOSC_MAX_HZ 407000
+#define SSD1306_FOSC_MARGIN_PCT 5
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -22,22 +49,109 @@ typedef enum {
   SET_DISP_CLK_DIV = 0xD5,
   SET_PRECHARGE = 0xD9,
   SET_VCOM_DESEL = 0xDB,
-  SET_CHARGE_PUMP = 0x8D
+  SET_CHARGE_PUMP = 0x8D,
+  SET_SCROLL_RIGHT = 0x26,
+  SET_SCROLL_LEFT = 0x27,
+  SET_SCROLL_OFF = 0x2E,
+  SET_SCROLL_ON = 0x2F,
+  SET_NOP = 0xE3
 } ssd1306_command_t;
 
-typedef struct {
+typedef struct ssd1306 ssd1306_t;
+
+// Chamado (em contexto de interrupção) quando a DMA termina de entregar o quadro
+typedef void (*ssd1306_flush_cb_t)(ssd1306_t *ssd, void *ctx);
+
+struct ssd1306 {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
-} ssd1306_t;
+  // Cópia do conteúdo que já está no painel (mesmo layout de ram_buffer)
+  uint8_t *sent_buffer;
+  bool panel_synced;
+  // Faixa de colunas alteradas por página desde o último flush (x0 > x1 = limpa)
+  uint8_t dirty_x0[SSD1306_MAX_PAGES];
+  uint8_t dirty_x1[SSD1306_MAX_PAGES];
+  // Envio assíncrono: canal DMA (-1 = desabilitado) e quadro em transmissão
+  int dma_channel;
+  uint16_t *tx_stream;
+  size_t tx_capacity;
+  ssd1306_flush_cb_t flush_cb;
+  void *flush_ctx;
+  // Bytes entregues ao I2C desde o init (controle + comandos + dados, sem o endereço)
+  uint32_t tx_bytes;
+  // Rolagem horizontal em andamento no controlador, ligada entre
+  // scroll_on_us e scroll_on_end_us (antes e depois da transação)
+  bool scroll_left;
+  uint8_t scroll_first, scroll_last;
+  uint16_t scroll_frames;
+  uint32_t scroll_on_us, scroll_on_end_us;
+  // Estado reaplicado pela recuperação junto com a configuração
+  uint8_t contrast;
+  bool display_on;
+  // Barramento: pinos (SSD1306_NO_PIN sem ssd1306_bus_init()) e falhas
+  uint8_t sda, scl;
+  bool bus_fault;          // Última transferência falhou; a próxima tenta recuperar
+  uint32_t recover_at_us;  // Próxima tentativa de recuperação
+  uint32_t dma_deadline_us; // Prazo do quadro em envio pela DMA
+  uint32_t bus_errors;     // Transferências sem resposta ou com prazo vencido
+  uint32_t bus_recoveries; // Recuperações bem-sucedidas
+};
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+// Inicia o barramento do display (o primeiro display de cada porta o
+// configura) e testa o painel em Fast-mode Plus; sem resposta, o barramento
+// cai para Fast-mode, também para os outros displays da porta. Retorna a
+// velocidade em Hz.
+uint ssd1306_bus_init(ssd1306_t *ssd, uint8_t sda, uint8_t scl);
+uint ssd1306_bus_baudrate(const ssd1306_t *ssd);
+// Libera o barramento, reinicia o I2C e reenvia a configuração, o contraste
+// e o liga/desliga; false se o painel continua sem responder
+bool ssd1306_recover(ssd1306_t *ssd);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count);
+void ssd1306_set_contrast(ssd1306_t *ssd, uint8_t contrast);
+void ssd1306_invert(ssd1306_t *ssd, bool invert);
+void ssd1306_display_on(ssd1306_t *ssd, bool on);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_flush(ssd1306_t *ssd);
+
+bool ssd1306_dma_init(ssd1306_t *ssd);
+bool ssd1306_flush_async(ssd1306_t *ssd);
+bool ssd1306_busy(ssd1306_t *ssd);
+void ssd1306_wait(ssd1306_t *ssd);
+void ssd1306_set_flush_callback(ssd1306_t *ssd, ssd1306_flush_cb_t cb, void *ctx);
+
+// Rolagem horizontal do controlador (0x26/0x27) nas páginas first..last:
+// uma coluna a cada `interval` quadros do painel (código de 3 bits do
+// datasheet, 0 = 5 quadros), sem tráfego I2C até ssd1306_scroll_stop().
+// A GDDRAM gira de fato; ao parar, a mesma rotação de `steps` colunas é
+// aplicada ao framebuffer e à cópia do painel.
+//
+// O painel não é lido de volta: quantos passos ele deu sai do tempo em que a
+// rolagem ficou ligada e da faixa de duração do quadro, calculada do clock
+// de ssd1306_config() e da faixa do oscilador. O primeiro passo cai entre
+// (n - 1) e n quadros depois de ligada, os seguintes a cada n quadros.
+void ssd1306_scroll_start(ssd1306_t *ssd, bool left, uint8_t first_page, uint8_t last_page, uint8_t interval);
+// Tempo ligada, a partir de ssd1306_scroll_start(), em que a rolagem deu com
+// certeza exatamente `steps` passos; min_us >= max_us se não há tal tempo
+void ssd1306_scroll_window(const ssd1306_t *ssd, uint8_t steps, uint32_t *min_us, uint32_t *max_us);
+// Desliga a rolagem. true se o painel com certeza deu `steps` passos; senão
+// a cópia das páginas roladas é invalidada, e o próximo flush (ou
+// ssd1306_send_pages()) as reenvia inteiras.
+bool ssd1306_scroll_stop(ssd1306_t *ssd, uint8_t steps);
+// Escreve bytes de página na coluna x, de first_page para baixo
+void ssd1306_column(ssd1306_t *ssd, uint8_t x, uint8_t first_page, const uint8_t *bytes, uint8_t count);
+// Envia só a coluna x das páginas first..last, numa janela de uma coluna;
+// false se não foi entregue
+bool ssd1306_send_column(ssd1306_t *ssd, uint8_t x, uint8_t first_page, uint8_t last_page);
+// Envia as páginas first..last inteiras, sem comparar com o painel; false se
+// não foram entregues
+bool ssd1306_send_pages(ssd1306_t *ssd, uint8_t first_page, uint8_t last_page);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -46,4 +160,6 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+
+#endif
@@ -0,0 +1,121 @@
+#include "telas.h"
+#include "hotpath.h"
+#include "treino.h"
+#include "probe.h"
+
+// Telas declaradas como widgets (lib/widget.h): cabeçalho, linhas e rótulos
+// são desenhados quando a tela entra; a cada fotografia só os campos cujo
+// valor mudou são redesenhados.
+
+#define CABECALHO_X ((128 - (11 * 8)) / 2) // "EMBARCATECH" centralizado
+
+// Tela de treino: velocidade, inclinação e distância atuais. Os widgets
+// dinâmicos vêm primeiro, indexados pelo enum.
+enum { TREINO_VELOCIDADE, TREINO_BARRA, TREINO_INCLINACAO, TREINO_DISTANCIA };
+
+static const widget_t widgets_treino[] = {
+  [TREINO_VELOCIDADE] = { .kind = WIDGET_NUMBER, .x = 0, .y = 20, .w = 120, .text = "Vel.: ", .suffix = " Km/h", .decimals = 1 },
+  [TREINO_BARRA] = { .kind = WIDGET_BAR, .x = 0, .y = 29, .w = 128, .h = 5, .max = TREINO_VELOCIDADE_MAX },
+  [TREINO_INCLINACAO] = { .kind = WIDGET_NUMBER, .x = 0, .y = 36, .w = 120, .text = "Inclin.: ", .suffix = "%", .decimals = 1 },
+  [TREINO_DISTANCIA] = { .kind = WIDGET_NUMBER, .x = 0, .y = 52, .w = 120, .text = "Distan.: ", .suffix = " m", .decimals = 1 },
+  { .kind = WIDGET_LABEL, .x = CABECALHO_X, .y = 2, .text = "EMBARCATECH" },
+  { .kind = WIDGET_HLINE, .x = 0, .y = 16, .w = 128 },
+};
+WIDGET_SCREEN(tela_treino, widgets_treino);
+
+// Tabela de médias, exibida na pausa e no fim do treino
+enum { MEDIAS_TEMPO, MEDIAS_DISTANCIA, MEDIAS_INCLINACAO, MEDIAS_VELOCIDADE };
+
+static const widget_t widgets_medias[] = {
+  // Campos limitados às colunas da tabela
+  [MEDIAS_TEMPO] = { .kind = WIDGET_NUMBER, .x = 2, .y = 30, .w = 52, .suffix = " s" },
+  [MEDIAS_DISTANCIA] = { .kind = WIDGET_NUMBER, .x = 2, .y = 50, .w = 52, .suffix = " m", .decimals = 1 },
+  [MEDIAS_INCLINACAO] = { .kind = WIDGET_NUMBER, .x = 57, .y = 30, .w = 70, .suffix = "%", .decimals = 1 },
+  [MEDIAS_VELOCIDADE] = { .kind = WIDGET_NUMBER, .x = 57, .y = 50, .w = 70, .suffix = " km/h", .decimals = 1 },
+  { .kind = WIDGET_FRAME, .x = 0, .y = 0, .w = 128, .h = 64 },
+  { .kind = WIDGET_VLINE, .x = 55, .y = 16, .h = 48 },
+  { .kind = WIDGET_HLINE, .x = 0, .y = 16, .w = 128 },
+  { .kind = WIDGET_HLINE, .x = 0, .y = 38, .w = 128 },
+  { .kind = WIDGET_LABEL, .x = CABECALHO_X, .y = 2, .text = "EMBARCATECH" },
+  { .kind = WIDGET_LABEL, .x = 2, .y = 20, .text = "Tempo" },
+  { .kind = WIDGET_LABEL, .x = 2, .y = 40, .text = "Dist." },
+  { .kind = WIDGET_LABEL, .x = 57, .y = 20, .text = "Incl. M." },
+  { .kind = WIDGET_LABEL, .x = 57, .y = 40, .text = "Vel. M." },
+};
+WIDGET_SCREEN(tela_medias, widgets_medias);
+
+// Mensagem de treino finalizado, só com textos fixos
+static const widget_t widgets_finalizado[] = {
+  { .kind = WIDGET_LABEL, .x = CABECALHO_X, .y = 10, .text = "TREINO" },
+  { .kind = WIDGET_LABEL, .x = CABECALHO_X, .y = 26, .text = "EMBARCATECH" },
+  { .kind = WIDGET_LABEL, .x = CABECALHO_X, .y = 42, .text = "FINALIZADO" },
+};
+WIDGET_SCREEN(tela_finalizado, widgets_finalizado);
+
+// Gráfico de velocidade e inclinação: os valores atuais no cabeçalho (página
+// 0); as páginas abaixo são do gráfico (lib/grafico.h)
+enum { GRAFICO_VELOCIDADE, GRAFICO_INCLINACAO };
+
+static const widget_t widgets_grafico[] = {
+  [GRAFICO_VELOCIDADE] = { .kind = WIDGET_NUMBER, .x = 0, .y = 0, .w = 72, .suffix = "km/h", .decimals = 1 },
+  [GRAFICO_INCLINACAO] = { .kind = WIDGET_NUMBER, .x = 80, .y = 0, .w = 48, .suffix = "%", .decimals = 1 },
+};
+WIDGET_SCREEN(tela_grafico, widgets_grafico);
+
+// Atualiza os campos da tela pedida na fotografia, sem enviar ao display
+void HOT_FUNC(desenhar_tela)(ssd1306_t *ssd, widget_state_t *estado, const telemetria_t *t) {
+  const widget_screen_t *tela;
+  switch (t->tela) {
+    case TELA_TREINO:
+      tela = &tela_treino;
+      widget_set(estado, TREINO_VELOCIDADE, t->velocidade);
+      widget_set(estado, TREINO_BARRA, t->velocidade);
+      widget_set(estado, TREINO_INCLINACAO, t->inclinacao);
+      widget_set(estado, TREINO_DISTANCIA, (int32_t)TREINO_DECIMOS_METRO(t->distancia_mm));
+      break;
+    case TELA_MEDIAS:
+      tela = &tela_medias;
+      widget_set(estado, MEDIAS_TEMPO, t->tempo_decorrido_s);
+      widget_set(estado, MEDIAS_DISTANCIA, (int32_t)TREINO_DECIMOS_METRO(t->distancia_mm));
+      widget_set(estado, MEDIAS_INCLINACAO, t->inclinacao_media);
+      widget_set(estado, MEDIAS_VELOCIDADE, t->velocidade_media);
+      break;
+    case TELA_FINALIZADO:
+      tela = &tela_finalizado;
+      break;
+    default:
+      return; // Tela inicial: o display fica como está
+  }
+
+  widget_show(ssd, estado, tela);
+}
+
+// Desenha e envia só o que mudou. A tela de treino vai por DMA: se o quadro
+// anterior ainda estiver saindo, as alterações ficam marcadas e seguem no
+// próximo quadro.
+void HOT_FUNC(renderizar_tela)(ssd1306_t *ssd, widget_state_t *estado, const telemetria_t *t) {
+  uint32_t probe = probe_start();
+  desenhar_tela(ssd, estado, t);
+  probe_record(PROBE_RENDER, probe);
+  if (t->tela == TELA_TREINO)
+    ssd1306_flush_async(ssd);
+  else
+    ssd1306_flush(ssd);
+}
+
+// Uma coluna nova rola o gráfico no painel; na entrada da tela ou depois de
+// várias colunas sem desenhar (tela trocada, display ocupado), o gráfico é
+// desenhado inteiro e o flush envia só o que difere do painel.
+void HOT_FUNC(renderizar_grafico)(ssd1306_t *ssd, widget_state_t *estado, grafico_t *grafico, const telemetria_t *t) {
+  uint32_t probe = probe_start();
+  bool entrou = estado->screen != &tela_grafico;
+  widget_set(estado, GRAFICO_VELOCIDADE, t->velocidade);
+  widget_set(estado, GRAFICO_INCLINACAO, t->inclinacao);
+  widget_show(ssd, estado, &tela_grafico);
+  if (entrou || grafico->pendentes > 1)
+    grafico_desenhar(ssd, grafico);
+  probe_record(PROBE_RENDER, probe);
+  ssd1306_flush(ssd);
+  if (grafico->pendentes == 1)
+    grafico_rolar(ssd, grafico);
+}
@@ -0,0 +1,51 @@
+#ifndef TELAS_H
+#define TELAS_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+#include "widget.h"
+#include "grafico.h"
+
+// Tela que o núcleo 1 deve exibir
+typedef enum {
+  TELA_INICIAL,
+  TELA_TREINO,
+  TELA_MEDIAS,
+  TELA_FINALIZADO
+} tela_t;
+
+// Estado de energia do display pedido pelo núcleo 0
+typedef enum {
+  ENERGIA_ATIVO,    // Contraste normal
+  ENERGIA_ESCURO,   // Contraste mínimo
+  ENERGIA_DORMINDO  // Display desligado (0xAE)
+} energia_t;
+
+// Fotografia do estado do treino publicada a cada mudança (unidades de treino.h)
+typedef struct {
+  uint32_t tick; // Incrementado a cada amostragem do joystick
+  tela_t tela;
+  uint16_t velocidade;       // 0,1 km/h
+  uint16_t inclinacao;       // 0,1 %
+  uint32_t distancia_mm;
+  uint16_t velocidade_media; // 0,1 km/h
+  uint16_t inclinacao_media; // 0,1 %
+  int tempo_decorrido_s;
+  uint32_t instante_ms; // Momento da publicação, desde o boot
+  bool em_andamento;
+  bool pausado;
+  bool emergencia;
+  energia_t energia;
+} telemetria_t;
+
+// Telas do display, compostas a partir da fotografia publicada pelo núcleo 0.
+// Cada display tem seu estado (widget_invalidate() força o desenho completo).
+void desenhar_tela(ssd1306_t *ssd, widget_state_t *estado, const telemetria_t *t);
+void renderizar_tela(ssd1306_t *ssd, widget_state_t *estado, const telemetria_t *t);
+// Tela de gráfico, no lugar da tela de treino: cabeçalho com os valores
+// atuais e o histórico do gráfico, que anda uma coluna por segundo pela
+// rolagem do controlador. Com a rolagem ligada (grafico->rolando), nada
+// pode ser enviado ao display até grafico_concluir_rolagem().
+void renderizar_grafico(ssd1306_t *ssd, widget_state_t *estado, grafico_t *grafico, const telemetria_t *t);
+
+#endif
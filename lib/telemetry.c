@@ -0,0 +1,124 @@
+#include "telemetry.h"
+
+uint16_t telemetry_crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)(*data++ << 8);
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+  p = put_u16(p, (uint16_t)v);
+  return put_u16(p, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+  return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+// COBS: cada zero vira a distância até o próximo zero (ou até o fim)
+static size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t code_pos = 0;
+  size_t out_pos = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; ++i) {
+    if (in[i] == 0) {
+      out[code_pos] = code;
+      code_pos = out_pos++;
+      code = 1;
+    } else {
+      out[out_pos++] = in[i];
+      if (++code == 0xFF) {
+        out[code_pos] = code;
+        code_pos = out_pos++;
+        code = 1;
+      }
+    }
+  }
+  out[code_pos] = code;
+  return out_pos;
+}
+
+// Retorna o tamanho decodificado, ou 0 se a sequência é inválida ou não cabe
+static size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t max) {
+  size_t out_pos = 0;
+  size_t i = 0;
+  while (i < len) {
+    uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > len)
+      return 0;
+    for (uint8_t k = 1; k < code; ++k) {
+      if (out_pos == max)
+        return 0;
+      out[out_pos++] = in[i++];
+    }
+    if (code != 0xFF && i < len) {
+      if (out_pos == max)
+        return 0;
+      out[out_pos++] = 0;
+    }
+  }
+  return out_pos;
+}
+
+size_t telemetry_frame(const uint8_t *raw, size_t len, uint8_t *frame) {
+  frame[0] = 0;
+  size_t out = 1 + cobs_encode(raw, len, frame + 1);
+  frame[out++] = 0;
+  return out;
+}
+
+size_t telemetry_unframe(const uint8_t *cobs, size_t len, uint8_t *raw, size_t max) {
+  return cobs_decode(cobs, len, raw, max);
+}
+
+size_t telemetry_encode(const telemetry_record_t *record, uint8_t frame[TELEMETRY_FRAME_MAX]) {
+  uint8_t raw[TELEMETRY_RECORD_SIZE];
+  uint8_t *p = raw;
+  *p++ = TELEMETRY_VERSION;
+  *p++ = record->flags;
+  *p++ = record->screen;
+  *p++ = record->lane;
+  p = put_u32(p, record->timestamp_ms);
+  p = put_u32(p, record->tick);
+  p = put_u16(p, record->speed);
+  p = put_u16(p, record->incline);
+  p = put_u32(p, record->distance_mm);
+  p = put_u16(p, record->elapsed_s);
+  put_u16(p, telemetry_crc16(raw, (size_t)(p - raw)));
+  return telemetry_frame(raw, sizeof(raw), frame);
+}
+
+bool telemetry_decode(const uint8_t *cobs, size_t len, telemetry_record_t *record) {
+  uint8_t raw[TELEMETRY_RECORD_SIZE];
+  if (telemetry_unframe(cobs, len, raw, sizeof(raw)) != sizeof(raw))
+    return false;
+  if (raw[0] != TELEMETRY_VERSION)
+    return false;
+  if (get_u16(raw + 22) != telemetry_crc16(raw, 22))
+    return false;
+
+  record->flags = raw[1];
+  record->screen = raw[2];
+  record->lane = raw[3];
+  record->timestamp_ms = get_u32(raw + 4);
+  record->tick = get_u32(raw + 8);
+  record->speed = get_u16(raw + 12);
+  record->incline = get_u16(raw + 14);
+  record->distance_mm = get_u32(raw + 16);
+  record->elapsed_s = get_u16(raw + 20);
+  return true;
+}
@@ -0,0 +1,66 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Telemetria binária: um registro de tamanho fixo por fotografia do treino,
+// protegido por CRC-16/CCITT-FALSE e enquadrado com COBS.
+//
+// Registro (little-endian), antes do COBS:
+//   0  u8   versão (TELEMETRY_VERSION)
+//   1  u8   flags (TELEMETRY_FLAG_*)
+//   2  u8   tela
+//   3  u8   esteira (lane)
+//   4  u32  instante em ms desde o boot
+//   8  u32  tick do controle
+//   12 u16  velocidade (0,1 km/h)
+//   14 u16  inclinação (0,1 %)
+//   16 u32  distância (mm)
+//   20 u16  tempo de treino (s)
+//   22 u16  CRC dos bytes 0..21
+//
+// Cada quadro vai entre dois bytes 0x00, de modo que texto solto na mesma
+// serial (respostas de comandos) nunca se mistura a um registro válido.
+//
+// Só usa a biblioteca C padrão: é compartilhado com o decodificador do host.
+
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_RECORD_SIZE 24
+// Delimitador inicial + COBS (1 byte de sobrecarga até 254 bytes) + final
+#define TELEMETRY_FRAME_MAX (TELEMETRY_RECORD_SIZE + 3)
+
+#define TELEMETRY_FLAG_RUNNING 0x01   // Treino em andamento
+#define TELEMETRY_FLAG_PAUSED 0x02    // Treino pausado
+#define TELEMETRY_FLAG_EMERGENCY 0x04 // Alerta de emergência ativo
+
+typedef struct {
+  uint32_t timestamp_ms;
+  uint32_t tick;
+  uint32_t distance_mm;
+  uint16_t speed;     // 0,1 km/h
+  uint16_t incline;   // 0,1 %
+  uint16_t elapsed_s;
+  uint8_t screen;
+  uint8_t flags;
+  uint8_t lane;
+} telemetry_record_t;
+
+uint16_t telemetry_crc16(const uint8_t *data, size_t len);
+
+// Enquadramento genérico, também usado pelo rastro de entradas (trace.h):
+// até 254 bytes viram 0x00, COBS, 0x00 (len + 3 bytes); o inverso recebe os
+// bytes entre os delimitadores e retorna o tamanho decodificado, ou 0 se a
+// sequência é inválida ou passa de max
+size_t telemetry_frame(const uint8_t *raw, size_t len, uint8_t *frame);
+size_t telemetry_unframe(const uint8_t *cobs, size_t len, uint8_t *raw, size_t max);
+
+// Monta o quadro completo (0x00, COBS, 0x00) e retorna seu tamanho
+size_t telemetry_encode(const telemetry_record_t *record, uint8_t frame[TELEMETRY_FRAME_MAX]);
+
+// Decodifica os bytes entre dois delimitadores; false se o tamanho, a versão
+// ou o CRC não conferem
+bool telemetry_decode(const uint8_t *cobs, size_t len, telemetry_record_t *record);
+
+#endif
@@ -0,0 +1,185 @@
+#include "trace.h"
+#include <string.h>
+#include "telemetry.h"
+
+#define TRACE_RAW_MAX (TRACE_BLOCK_PAYLOAD + 4) // Marca, sequência, eventos e CRC
+
+static uint8_t *put_varint(uint8_t *p, uint64_t v) {
+  while (v >= 0x80) {
+    *p++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+// Zigzag: diferenças pequenas, positivas ou negativas, em poucos bytes
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Lê um varint de no máximo 10 bytes; retorna o tamanho ou 0 se não cabe
+static size_t get_varint(const uint8_t *p, size_t len, uint64_t *v) {
+  *v = 0;
+  for (size_t i = 0; i < len && i < 10; ++i) {
+    *v |= (uint64_t)(p[i] & 0x7F) << (7 * i);
+    if (!(p[i] & 0x80))
+      return i + 1;
+  }
+  return 0;
+}
+
+void trace_writer_init(trace_writer_t *w) {
+  memset(w, 0, sizeof(*w));
+}
+
+static size_t trace_encode(trace_writer_t *w, const trace_event_t *event, uint8_t out[TRACE_EVENT_MAX]) {
+  uint8_t *p = out;
+  *p++ = (uint8_t)(event->kind << 5 | (event->channel & 0x1F));
+  p = put_varint(p, event->time_us - w->last_us);
+  w->last_us = event->time_us;
+  if (event->kind == TRACE_ADC) {
+    p = put_varint(p, zigzag(event->value - w->last_adc[event->channel]));
+    w->last_adc[event->channel] = event->value;
+  } else if (event->kind != TRACE_STEP) {
+    p = put_varint(p, (uint32_t)event->value);
+  }
+  return (size_t)(p - out);
+}
+
+bool trace_write(trace_writer_t *w, const trace_event_t *event, trace_block_t *full) {
+  if (event->kind == TRACE_ADC && event->channel >= TRACE_ADC_CHANNELS)
+    return false;
+
+  uint8_t encoded[TRACE_EVENT_MAX];
+  size_t len = trace_encode(w, event, encoded);
+  bool filled = w->block.length + len > TRACE_BLOCK_PAYLOAD;
+  if (filled)
+    trace_flush(w, full);
+  memcpy(w->block.data + w->block.length, encoded, len);
+  w->block.length += (uint8_t)len;
+  return filled;
+}
+
+bool trace_flush(trace_writer_t *w, trace_block_t *full) {
+  if (w->block.length == 0)
+    return false;
+  *full = w->block;
+  w->block.seq++;
+  w->block.length = 0;
+  return true;
+}
+
+size_t trace_frame(const trace_block_t *block, uint8_t frame[TRACE_FRAME_MAX]) {
+  uint8_t raw[TRACE_RAW_MAX];
+  raw[0] = TRACE_BLOCK_TAG;
+  raw[1] = block->seq;
+  memcpy(raw + 2, block->data, block->length);
+  size_t len = 2 + block->length;
+  uint16_t crc = telemetry_crc16(raw, len);
+  raw[len++] = (uint8_t)crc;
+  raw[len++] = (uint8_t)(crc >> 8);
+  return telemetry_frame(raw, len, frame);
+}
+
+void trace_reader_init(trace_reader_t *r, const uint8_t *capture, size_t size) {
+  memset(r, 0, sizeof(*r));
+  r->data = capture;
+  r->size = size;
+}
+
+// Avança até o próximo bloco válido da captura; false no fim dela
+static bool trace_load_block(trace_reader_t *r) {
+  while (r->pos < r->size) {
+    while (r->pos < r->size && r->data[r->pos] == 0)
+      ++r->pos;
+    size_t start = r->pos;
+    while (r->pos < r->size && r->data[r->pos] != 0)
+      ++r->pos;
+    if (r->pos == r->size)
+      return false; // Trecho cortado no fim da captura
+
+    uint8_t raw[TRACE_RAW_MAX];
+    size_t len = telemetry_unframe(r->data + start, r->pos - start, raw, sizeof(raw));
+    if (len < 4 || raw[0] != TRACE_BLOCK_TAG)
+      continue; // Telemetria, texto ou lixo
+    if ((uint16_t)(raw[len - 2] | raw[len - 1] << 8) != telemetry_crc16(raw, len - 2))
+      continue;
+    if (r->started && raw[1] != r->next_seq) {
+      r->broken = true;
+      return false;
+    }
+    r->started = true;
+    r->next_seq = (uint8_t)(raw[1] + 1);
+    r->block_len = (uint8_t)(len - 4);
+    r->block_pos = 0;
+    memcpy(r->block, raw + 2, r->block_len);
+    ++r->blocks;
+    return true;
+  }
+  return false;
+}
+
+// Decodifica o evento em p; retorna os bytes usados ou 0 se é inválido
+static size_t trace_decode_event(trace_reader_t *r, const uint8_t *p, size_t left, trace_event_t *e) {
+  e->kind = p[0] >> 5;
+  e->channel = p[0] & 0x1F;
+  e->value = 0;
+  uint64_t v;
+  size_t used = 1;
+  size_t n = get_varint(p + used, left - used, &v);
+  if (n == 0)
+    return 0;
+  used += n;
+  e->time_us = r->last_us + v;
+
+  if (e->kind == TRACE_STEP)
+    return used;
+  if (e->kind == TRACE_ADC && e->channel >= TRACE_ADC_CHANNELS)
+    return 0;
+  if (e->kind > TRACE_CONFIG || (n = get_varint(p + used, left - used, &v)) == 0)
+    return 0;
+  used += n;
+  if (e->kind == TRACE_ADC)
+    e->value = r->last_adc[e->channel] + unzigzag((uint32_t)v);
+  else
+    e->value = (int32_t)v;
+  return used;
+}
+
+static bool trace_decode(trace_reader_t *r) {
+  while (r->block_pos >= r->block_len) {
+    if (!trace_load_block(r))
+      return false;
+  }
+
+  trace_event_t *e = &r->event;
+  size_t used = trace_decode_event(r, r->block + r->block_pos, r->block_len - r->block_pos, e);
+  if (used == 0) {
+    r->broken = true;
+    return false;
+  }
+  r->last_us = e->time_us;
+  if (e->kind == TRACE_ADC)
+    r->last_adc[e->channel] = e->value;
+  r->block_pos += (uint8_t)used;
+  return true;
+}
+
+bool trace_peek(trace_reader_t *r, trace_event_t *event) {
+  if (!r->has_event) {
+    if (r->broken || !trace_decode(r))
+      return false;
+    r->has_event = true;
+  }
+  *event = r->event;
+  return true;
+}
+
+void trace_next(trace_reader_t *r) {
+  r->has_event = false;
+}
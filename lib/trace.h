@@ -0,0 +1,94 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Rastro das entradas do controle, para reproduzir um treino bit a bit.
+//
+// O controle só depende do relógio, dos eixos do joystick e dos eventos de
+// botão. O rastro guarda cada passo de controle (a tarefa e o instante em
+// µs), as leituras do ADC consumidas nele e os eventos de botão tratados;
+// reproduzir a mesma sequência dá a mesma distância e as mesmas médias.
+//
+// Evento codificado:
+//   u8      tipo (3 bits altos) e canal (5 bits baixos)
+//   varint  µs desde o evento anterior (LEB128)
+//   ADC:    varint zigzag da diferença para a leitura anterior do canal
+//   BUTTON, CONFIG: varint do valor
+//
+// Os eventos são agrupados em blocos de até TRACE_BLOCK_PAYLOAD bytes, cada
+// um com marca, número de sequência e CRC-16, enquadrados com COBS como a
+// telemetria (telemetry_frame()): os quadros se intercalam com a telemetria
+// e o texto na mesma serial, e a leitura descarta o resto. Como as
+// diferenças continuam de um bloco para o outro, um bloco perdido encerra a
+// leitura (número de sequência fora de ordem).
+//
+// Só usa a biblioteca C padrão: é compartilhado com o simulador do host.
+
+#define TRACE_BLOCK_TAG 0x54 // 'T': não se confunde com a versão da telemetria
+#define TRACE_BLOCK_PAYLOAD 200
+// Delimitador, COBS de marca + sequência + eventos + CRC, delimitador
+#define TRACE_FRAME_MAX (TRACE_BLOCK_PAYLOAD + 4 + 3)
+#define TRACE_EVENT_MAX 16
+#define TRACE_ADC_CHANNELS 5
+
+typedef enum {
+  TRACE_STEP,   // Passo de controle; canal = tarefa
+  TRACE_ADC,    // Leitura consumida pelo passo; canal = entrada do ADC
+  TRACE_BUTTON, // Evento de botão; canal = botão, valor = tipo do evento
+  TRACE_CONFIG, // Configuração no início do rastro; canal = item
+} trace_kind_t;
+
+typedef struct {
+  uint64_t time_us;
+  int32_t value;
+  uint8_t kind;    // trace_kind_t
+  uint8_t channel; // 0..31
+} trace_event_t;
+
+typedef struct {
+  uint8_t seq;
+  uint8_t length;
+  uint8_t data[TRACE_BLOCK_PAYLOAD];
+} trace_block_t;
+
+typedef struct {
+  trace_block_t block; // Bloco em preenchimento
+  uint64_t last_us;
+  int32_t last_adc[TRACE_ADC_CHANNELS];
+} trace_writer_t;
+
+typedef struct {
+  const uint8_t *data; // Captura da serial
+  size_t size;
+  size_t pos;
+  uint8_t block[TRACE_BLOCK_PAYLOAD];
+  uint8_t block_len;
+  uint8_t block_pos;
+  uint8_t next_seq;
+  bool started;
+  bool broken;         // Bloco perdido ou evento inválido: a leitura parou
+  uint32_t blocks;
+  uint64_t last_us;
+  int32_t last_adc[TRACE_ADC_CHANNELS];
+  trace_event_t event; // Próximo evento, já decodificado
+  bool has_event;
+} trace_reader_t;
+
+void trace_writer_init(trace_writer_t *w);
+// Acrescenta o evento; se ele não coube, o bloco cheio é copiado em *full,
+// o evento abre o bloco seguinte e o retorno é true
+bool trace_write(trace_writer_t *w, const trace_event_t *event, trace_block_t *full);
+// Fecha o bloco em preenchimento, se houver algo nele
+bool trace_flush(trace_writer_t *w, trace_block_t *full);
+// Monta o quadro do bloco e retorna seu tamanho
+size_t trace_frame(const trace_block_t *block, uint8_t frame[TRACE_FRAME_MAX]);
+
+void trace_reader_init(trace_reader_t *r, const uint8_t *capture, size_t size);
+// Próximo evento sem consumi-lo; false no fim do rastro ou se ele quebrou
+bool trace_peek(trace_reader_t *r, trace_event_t *event);
+void trace_next(trace_reader_t *r);
+
+#endif
@@ -0,0 +1,96 @@
+#include "treino.h"
+#include "hotpath.h"
+
+const uint16_t treino_inclinacao_niveis[TREINO_NIVEIS_INCLINACAO] = { 0, 30, 60, 90, TREINO_INCLINACAO_MAX };
+
+void treino_reiniciar(treino_t *t, uint64_t agora_us) {
+  t->velocidade = 0;
+  t->indice_inclinacao = 0;
+  t->inclinacao = treino_inclinacao_niveis[0];
+  t->distancia = 0;
+  t->ultimo_us = agora_us;
+  t->tempo_ativo_us = 0;
+  estatistica_iniciar(&t->estat_velocidade, TREINO_FAIXA_VELOCIDADE);
+  estatistica_iniciar(&t->estat_inclinacao, TREINO_FAIXA_INCLINACAO);
+  t->km_completos = 0;
+  t->inicio_km_us = 0;
+  t->ultimo_km_ms = 0;
+  t->melhor_km_ms = 0;
+  t->pior_km_ms = 0;
+}
+
+// Após uma pausa, o intervalo parado não entra na integração
+void treino_retomar(treino_t *t, uint64_t agora_us) {
+  t->ultimo_us = agora_us;
+}
+
+// Fecha o km que terminou dentro do intervalo integrado agora
+static void HOT_FUNC(treino_fechar_km)(treino_t *t, uint64_t distancia_antes, uint64_t tempo_antes_us) {
+  uint64_t limite = (uint64_t)(t->km_completos + 1) * TREINO_UNIDADES_POR_KM;
+  // A velocidade é constante no intervalo: o km fecha proporcionalmente
+  uint64_t fim_km_us = tempo_antes_us + (limite - distancia_antes) / t->velocidade;
+  uint32_t parcial_ms = (uint32_t)((fim_km_us - t->inicio_km_us) / 1000);
+
+  t->ultimo_km_ms = parcial_ms;
+  if (t->km_completos == 0 || parcial_ms < t->melhor_km_ms)
+    t->melhor_km_ms = parcial_ms;
+  if (parcial_ms > t->pior_km_ms)
+    t->pior_km_ms = parcial_ms;
+  t->km_completos++;
+  t->inicio_km_us = fim_km_us;
+}
+
+void HOT_FUNC(treino_ajustar)(treino_t *t, uint16_t valor_x, uint16_t valor_y) {
+  // Atualiza a inclinação apenas se o joystick for movido para cima ou para baixo
+  if (valor_y > 3000 && t->indice_inclinacao < TREINO_NIVEIS_INCLINACAO - 1)
+    t->indice_inclinacao++;
+  else if (valor_y < 1000 && t->indice_inclinacao > 0)
+    t->indice_inclinacao--;
+  t->inclinacao = treino_inclinacao_niveis[t->indice_inclinacao];
+
+  // Atualiza a velocidade apenas se o joystick for movido para os lados
+  if (valor_x > 3000 && t->velocidade < TREINO_VELOCIDADE_MAX)
+    t->velocidade += TREINO_PASSO_VELOCIDADE;
+  else if (valor_x < 1000 && t->velocidade > 0)
+    t->velocidade -= TREINO_PASSO_VELOCIDADE;
+}
+
+bool HOT_FUNC(treino_integrar)(treino_t *t, uint64_t agora_us) {
+  // Integração exata: velocidade (0,1 km/h) x intervalo (µs)
+  uint64_t dt_us = agora_us - t->ultimo_us;
+  if (dt_us == 0)
+    return false;
+  uint64_t distancia_antes = t->distancia;
+  uint64_t tempo_antes_us = t->tempo_ativo_us;
+  t->distancia += (uint64_t)t->velocidade * dt_us;
+  t->tempo_ativo_us += dt_us;
+  t->ultimo_us = agora_us;
+
+  estatistica_adicionar(&t->estat_velocidade, t->velocidade, dt_us);
+  estatistica_adicionar(&t->estat_inclinacao, t->inclinacao, dt_us);
+
+  // A 14 km/h um intervalo de 500 ms anda ~2 m: no máximo um km fecha por vez
+  if (t->distancia >= (uint64_t)(t->km_completos + 1) * TREINO_UNIDADES_POR_KM) {
+    treino_fechar_km(t, distancia_antes, tempo_antes_us);
+    return true;
+  }
+  return false;
+}
+
+bool HOT_FUNC(treino_tick)(treino_t *t, uint16_t valor_x, uint16_t valor_y, uint64_t agora_us) {
+  treino_ajustar(t, valor_x, valor_y);
+  return treino_integrar(t, agora_us);
+}
+
+uint32_t HOT_FUNC(treino_distancia_mm)(const treino_t *t) {
+  return (uint32_t)(t->distancia / TREINO_UNIDADES_POR_MM);
+}
+
+// Médias ponderadas pelo tempo de cada tick
+uint16_t HOT_FUNC(treino_velocidade_media)(const treino_t *t) {
+  return estatistica_media(&t->estat_velocidade);
+}
+
+uint16_t HOT_FUNC(treino_inclinacao_media)(const treino_t *t) {
+  return estatistica_media(&t->estat_inclinacao);
+}
@@ -0,0 +1,77 @@
+#ifndef TREINO_H
+#define TREINO_H
+
+#include "pico/stdlib.h"
+#include "estatistica.h"
+
+// Aritmética do treino em ponto fixo (o Cortex-M0+ não tem FPU).
+//
+// Unidades:
+//   velocidade  - décimos de km/h (0,1 km/h)
+//   inclinação  - décimos de ponto percentual (0,1 %)
+//   distância   - acumulada em (0,1 km/h)·µs, exata; 36000 unidades = 1 mm
+//
+// A rampa (treino_ajustar) e a integração (treino_integrar) rodam em ritmos
+// independentes: a velocidade muda em passos e é constante entre eles.
+//
+// A distância é integrada com o intervalo real entre chamadas em microssegundos,
+// sem arredondamento, de modo que sessões longas não acumulam deriva. As
+// estatísticas usam o mesmo intervalo como peso: velocidade média x tempo
+// ativo = distância.
+//
+// Parciais por km: o instante em que cada km se completa é interpolado
+// dentro do tick, e só o último, o melhor e o pior ficam guardados.
+
+#define TREINO_VELOCIDADE_MAX 140 // 14,0 km/h
+#define TREINO_PASSO_VELOCIDADE 5 // 0,5 km/h por tick
+#define TREINO_NIVEIS_INCLINACAO 5
+#define TREINO_INCLINACAO_MAX 120 // 12,0 %, o último nível
+#define TREINO_UNIDADES_POR_MM 36000u
+#define TREINO_UNIDADES_POR_KM (TREINO_UNIDADES_POR_MM * 1000000ull)
+
+// Faixas dos histogramas: 1 km/h e um nível de inclinação
+#define TREINO_FAIXA_VELOCIDADE 10
+#define TREINO_FAIXA_INCLINACAO 30
+
+typedef struct {
+  uint16_t velocidade;      // 0,1 km/h
+  uint16_t inclinacao;      // 0,1 %
+  uint8_t indice_inclinacao;
+  uint64_t distancia;       // (0,1 km/h)·µs
+  uint64_t ultimo_us;       // Instante do último tick integrado
+  uint64_t tempo_ativo_us;  // Tempo integrado, sem as pausas
+  estatistica_t estat_velocidade;
+  estatistica_t estat_inclinacao;
+  // Parciais por km, em tempo ativo
+  uint32_t km_completos;
+  uint64_t inicio_km_us;    // Tempo ativo em que o km atual começou
+  uint32_t ultimo_km_ms;
+  uint32_t melhor_km_ms;
+  uint32_t pior_km_ms;
+} treino_t;
+
+extern const uint16_t treino_inclinacao_niveis[TREINO_NIVEIS_INCLINACAO];
+
+void treino_reiniciar(treino_t *t, uint64_t agora_us);
+void treino_retomar(treino_t *t, uint64_t agora_us);
+// Rampa: um passo de velocidade e de nível de inclinação conforme o joystick
+void treino_ajustar(treino_t *t, uint16_t valor_x, uint16_t valor_y);
+// Integra distância e estatísticas até agora com a velocidade atual; retorna
+// true quando um km se completou no intervalo (ver ultimo_km_ms)
+bool treino_integrar(treino_t *t, uint64_t agora_us);
+// Ajuste seguido de integração, no mesmo instante
+bool treino_tick(treino_t *t, uint16_t valor_x, uint16_t valor_y, uint64_t agora_us);
+
+uint32_t treino_distancia_mm(const treino_t *t);
+uint16_t treino_velocidade_media(const treino_t *t);
+uint16_t treino_inclinacao_media(const treino_t *t);
+
+// Argumentos para imprimir um tempo em ms como "%u:%02u" (min:s)
+#define TREINO_MIN_SEG(ms) (unsigned)(((ms) + 500) / 60000), (unsigned)(((ms) + 500) / 1000 % 60)
+
+// Argumentos para imprimir um valor em décimos com "%u.%u"
+#define TREINO_DECIMOS(v) (unsigned)((v) / 10), (unsigned)((v) % 10)
+// Distância em décimos de metro, arredondada
+#define TREINO_DECIMOS_METRO(mm) (((mm) + 50) / 100)
+
+#endif
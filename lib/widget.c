@@ -0,0 +1,128 @@
+#include "widget.h"
+#include "hotpath.h"
+
+#define WIDGET_CHAR_WIDTH 8
+#define WIDGET_CHAR_HEIGHT 8
+
+// Formata prefixo + valor + sufixo sem printf; retorna o tamanho
+static uint HOT_FUNC(widget_format)(const widget_t *w, int32_t value, char *out, uint size) {
+  uint n = 0;
+  for (const char *p = w->text; p && *p && n < size - 1; ++p)
+    out[n++] = *p;
+
+  char digits[16];
+  uint count = 0;
+  uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+  do {
+    digits[count++] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+    if (count == w->decimals)
+      digits[count++] = '.';
+  } while (magnitude > 0 || count <= w->decimals);
+  if (digits[count - 1] == '.')
+    digits[count++] = '0'; // Zero antes da vírgula
+  if (value < 0)
+    digits[count++] = '-';
+  while (count > 0 && n < size - 1)
+    out[n++] = digits[--count];
+
+  for (const char *p = w->suffix; p && *p && n < size - 1; ++p)
+    out[n++] = *p;
+  out[n] = '\0';
+  return n;
+}
+
+static void HOT_FUNC(widget_draw_number)(ssd1306_t *ssd, const widget_t *w, int32_t value) {
+  char text[24];
+  uint length = widget_format(w, value, text, sizeof(text));
+  uint fit = w->w / WIDGET_CHAR_WIDTH;
+  if (length > fit)
+    length = fit;
+
+  // Os espaços não têm glifo: o campo é limpo antes do texto
+  ssd1306_rect(ssd, w->y, w->x, w->w, WIDGET_CHAR_HEIGHT, false, true);
+  for (uint i = 0; i < length; ++i)
+    ssd1306_draw_char(ssd, text[i], (uint8_t)(w->x + i * WIDGET_CHAR_WIDTH), w->y);
+}
+
+static uint8_t HOT_FUNC(widget_bar_fill)(const widget_t *w, int32_t value) {
+  uint inner = w->w - 2;
+  if (value <= 0 || w->max == 0)
+    return 0;
+  if ((uint32_t)value >= w->max)
+    return (uint8_t)inner;
+  return (uint8_t)((uint32_t)value * inner / w->max);
+}
+
+// Só a diferença entre o preenchimento antigo e o novo é alterada
+static void HOT_FUNC(widget_draw_bar)(ssd1306_t *ssd, const widget_t *w, int32_t old_value, int32_t value) {
+  uint8_t before = widget_bar_fill(w, old_value);
+  uint8_t after = widget_bar_fill(w, value);
+  uint8_t top = w->y + 1;
+  uint8_t height = w->h - 2;
+  if (after > before)
+    ssd1306_rect(ssd, top, w->x + 1 + before, after - before, height, true, true);
+  else if (after < before)
+    ssd1306_rect(ssd, top, w->x + 1 + after, before - after, height, false, true);
+}
+
+static void HOT_FUNC(widget_draw_static)(ssd1306_t *ssd, const widget_t *w) {
+  switch (w->kind) {
+    case WIDGET_LABEL:
+      ssd1306_draw_string(ssd, w->text, w->x, w->y);
+      break;
+    case WIDGET_HLINE:
+      ssd1306_hline(ssd, w->x, w->x + w->w - 1, w->y, true);
+      break;
+    case WIDGET_VLINE:
+      ssd1306_vline(ssd, w->x, w->y, w->y + w->h - 1, true);
+      break;
+    case WIDGET_FRAME:
+      ssd1306_rect(ssd, w->y, w->x, w->w, w->h, true, false);
+      break;
+    case WIDGET_BAR:
+      ssd1306_rect(ssd, w->y, w->x, w->w, w->h, true, false);
+      break;
+    default:
+      break;
+  }
+}
+
+void HOT_FUNC(widget_draw_all)(ssd1306_t *ssd, widget_state_t *state, const widget_screen_t *screen) {
+  ssd1306_fill(ssd, false);
+  for (uint i = 0; i < screen->count; ++i) {
+    const widget_t *w = &screen->widgets[i];
+    widget_draw_static(ssd, w);
+    if (w->kind == WIDGET_NUMBER)
+      widget_draw_number(ssd, w, state->values[i]);
+    else if (w->kind == WIDGET_BAR)
+      widget_draw_bar(ssd, w, 0, state->values[i]);
+    state->shown[i] = state->values[i];
+  }
+  state->screen = screen;
+}
+
+uint HOT_FUNC(widget_update)(ssd1306_t *ssd, widget_state_t *state) {
+  const widget_screen_t *screen = state->screen;
+  uint redrawn = 0;
+  for (uint i = 0; screen && i < screen->count; ++i) {
+    if (state->values[i] == state->shown[i])
+      continue;
+    const widget_t *w = &screen->widgets[i];
+    if (w->kind == WIDGET_NUMBER)
+      widget_draw_number(ssd, w, state->values[i]);
+    else if (w->kind == WIDGET_BAR)
+      widget_draw_bar(ssd, w, state->shown[i], state->values[i]);
+    state->shown[i] = state->values[i];
+    ++redrawn;
+  }
+  return redrawn;
+}
+
+uint HOT_FUNC(widget_show)(ssd1306_t *ssd, widget_state_t *state, const widget_screen_t *screen) {
+  if (state->screen != screen) {
+    widget_draw_all(ssd, state, screen);
+    return screen->count;
+  }
+  return widget_update(ssd, state);
+}
@@ -0,0 +1,75 @@
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Camada de widgets em modo retido sobre o framebuffer do SSD1306.
+//
+// Uma tela é uma lista constante de widgets. Os estáticos (textos, linhas,
+// molduras) só são desenhados quando a tela entra; os dinâmicos (campos
+// numéricos, barras) guardam o último valor desenhado e, a cada
+// widget_update(), só os que mudaram são redesenhados - e só as páginas que
+// eles ocupam ficam sujas para o flush. Um quadro sem mudanças custa uma
+// comparação por widget.
+//
+// Widgets dinâmicos não podem se sobrepor: cada um limpa a própria área.
+//
+// A tela (widget_screen_t) é só o layout constante; o que foi desenhado
+// fica num widget_state_t por framebuffer, de modo que vários displays podem
+// mostrar as mesmas telas com valores diferentes.
+
+#define WIDGET_MAX 16 // Widgets por tela
+
+typedef enum {
+  WIDGET_LABEL,  // Texto fixo em (x, y)
+  WIDGET_HLINE,  // Linha horizontal de largura w
+  WIDGET_VLINE,  // Linha vertical de altura h
+  WIDGET_FRAME,  // Retângulo vazio w x h
+  WIDGET_NUMBER, // Prefixo + valor + sufixo num campo de w pixels (dinâmico)
+  WIDGET_BAR,    // Barra com moldura, cheia em value = max (dinâmico)
+} widget_kind_t;
+
+typedef struct {
+  widget_kind_t kind;
+  uint8_t x, y, w, h;
+  const char *text;   // LABEL: o texto; NUMBER: prefixo (ou NULL)
+  const char *suffix; // NUMBER: sufixo (ou NULL)
+  uint8_t decimals;   // NUMBER: casas decimais do valor (décimos = 1)
+  uint16_t max;       // BAR: valor da barra cheia
+} widget_t;
+
+typedef struct {
+  const widget_t *widgets;
+  uint8_t count;
+} widget_screen_t;
+
+// Estado de um framebuffer
+typedef struct {
+  const widget_screen_t *screen; // Tela desenhada; NULL força o desenho completo
+  int32_t values[WIDGET_MAX];    // Valor pedido, por widget
+  int32_t shown[WIDGET_MAX];     // Valor no framebuffer, por widget
+} widget_state_t;
+
+// Declara o layout constante de uma tela
+#define WIDGET_SCREEN(name, list)                                                  \
+  _Static_assert(sizeof(list) / sizeof((list)[0]) <= WIDGET_MAX, #list);           \
+  static const widget_screen_t name = { (list), sizeof(list) / sizeof((list)[0]) }
+
+static inline void widget_set(widget_state_t *state, uint index, int32_t value) {
+  state->values[index] = value;
+}
+
+// O framebuffer foi alterado por fora: o próximo widget_show() desenha tudo
+static inline void widget_invalidate(widget_state_t *state) {
+  state->screen = NULL;
+}
+
+// Limpa o framebuffer e desenha a tela inteira
+void widget_draw_all(ssd1306_t *ssd, widget_state_t *state, const widget_screen_t *screen);
+// Redesenha só os widgets dinâmicos cujo valor mudou; retorna quantos
+uint widget_update(ssd1306_t *ssd, widget_state_t *state);
+// Desenha a tela inteira se ela acabou de entrar, senão só o que mudou
+uint widget_show(ssd1306_t *ssd, widget_state_t *state, const widget_screen_t *screen);
+
+#endif
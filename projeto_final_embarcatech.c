@@ -1,59 +1,299 @@
 #include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/util/queue.h"
+#include "pico/flash.h"
 #include "hardware/adc.h"
 #include "hardware/gpio.h"
 #include "hardware/timer.h"
 #include "hardware/pwm.h"
 #include "hardware/i2c.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/watchdog.h"
+#if LIB_PICO_STDIO_UART
+#include "hardware/uart.h"
+#endif
+#include "lib/hotpath.h"
 #include "lib/ssd1306.h"
 #include "lib/font.h"
-
-// Declaração das funções
-void exibir_medias_display(); // Adicione esta linha
-void exibir_mensagem_finalizado(); // Adicione esta linha
-
-// Definição dos pinos do joystick, buzzer e botão A
-#define JOYSTICK_X 26      // Pino ADC para eixo X (velocidade)
-#define JOYSTICK_Y 27      // Pino ADC para eixo Y (inclinação)
-#define JOYSTICK_BUTTON 22 // Pino digital para o botão do joystick
-#define BUZZER 21          // Pino digital para o buzzer
-#define BOTAO_A 5         // Pino digital para o botão A
-#define LED_AZUL 12
-#define LED_VERMELHO 13    // Pino digital para o LED vermelho
-#define BOTAO_B 6          // Pino digital para o botão B
-
-// Definição dos pinos I2C para o display OLED
-#define I2C_PORT i2c1
-#define I2C_SDA 14
-#define I2C_SCL 15
-#define OLED_ADDRESS 0x3C
-
-// Definição dos níveis de inclinação e velocidade
-const float inclinacao_niveis[] = {0.0, 3.0, 6.0, 9.0, 12.0};
-const int velocidade_max = 14; // Máxima velocidade em km/h
-
-// Variáveis globais para controle do treino
-float velocidade_atual = 0.0;
-float inclinacao_atual = 0.0;
-float distancia_percorrida = 0.0;
-float soma_velocidade = 0.0;
-float soma_inclinacao = 0.0;
-int contador_medidas = 0;
-bool treino_em_andamento = false;
-bool treino_pausado = false;
-absolute_time_t tempo_anterior;
-absolute_time_t tempo_inicio_treino;
-absolute_time_t tempo_pausa_inicio;
+#include "lib/input.h"
+#include "lib/pattern.h"
+#include "lib/adc_stream.h"
+#include "lib/seqlock.h"
+#include "lib/treino.h"
+#include "lib/telas.h"
+#include "lib/probe.h"
+#include "lib/boot_profile.h"
+#include "lib/telemetry.h"
+#include "lib/recorder.h"
+#include "lib/scheduler.h"
+#include "lib/trace.h"
+
+// Divisão de trabalho entre os núcleos:
+//   núcleo 0 - botões, joystick, cálculo do treino, buzzer e LEDs;
+//   núcleo 1 - display OLED (renderização e I2C) e saída na stdio.
+// No núcleo 0, cada atividade é uma tarefa periódica com ritmo próprio,
+// rodada pelo escalonador EDF (lib/scheduler.h): botões a 100 Hz,
+// integração da distância a 50 Hz, rampa do joystick a 2 Hz, publicação
+// para o display a 10 Hz e LED azul a 1 Hz.
+//
+// O núcleo 0 publica fotografias imutáveis do estado (telemetria_t) por um
+// seqlock e mensagens de texto por uma fila; ele nunca espera pelo núcleo 1.
+//
+// Um mesmo firmware atende NUM_ESTEIRAS esteiras (cmake
+// -DEMBARCATECH_ESTEIRAS=2): cada uma tem seu esteira_t, com o mapa de pinos
+// e periféricos, o treino e o canal para o núcleo 1. Cada tarefa do núcleo 0
+// percorre todas as esteiras no mesmo período, e o núcleo 1 atende os
+// displays em rodízio sem esperar por um barramento I2C ocupado: o custo
+// cresce linearmente e o display de uma esteira não atrasa o controle nem o
+// display da outra.
+//
+// Parada, a esteira economiza energia em dois degraus: depois de
+// OCIOSO_ESCURECER_MS o display vai ao contraste mínimo e, depois de
+// OCIOSO_DORMIR_MS, o display desliga, o clk_sys cai para 48 MHz e o núcleo
+// 0 dorme em __wfe() sem nenhuma tarefa até a borda de um botão. Com várias
+// esteiras, só quando todas estão paradas.
+//
+// Na serial, o padrão é a telemetria binária (lib/telemetry.h): um quadro
+// COBS de 27 bytes por fotografia, decodificado no PC por telemetria_csv.
+// O log em texto (uma linha por tick e as mensagens) é opcional, para
+// depuração: cmake -DEMBARCATECH_LOG_TEXTO=ON ou o comando "log texto".
+//
+// O controle lê o relógio só pelo instante do passo atual (agora()), e as
+// únicas outras entradas são os eixos do joystick e os eventos de botão. O
+// comando "rastro iniciar" (ou cmake -DEMBARCATECH_RASTRO=ON, desde o boot)
+// envia essas entradas pela serial num rastro binário (lib/trace.h); a
+// captura reproduzida (-r no host, ou -DEMBARCATECH_REPRODUZIR=<captura> na
+// placa) roda os mesmos passos, em tempo real ou o mais rápido possível, e
+// dá a mesma distância e as mesmas médias.
+//
+// Um travamento não perde o treino: o watchdog é alimentado por uma tarefa
+// do núcleo 0 só enquanto o núcleo 1 também anda, e o estado dos treinos vai
+// a cada passo para uma área da RAM que o boot não zera. Depois de um
+// reinício pelo watchdog, main() retoma os treinos desse checkpoint em vez de
+// começar do zero, sem beeps nem mensagens de início.
+
+#ifndef LOG_TEXTO_PADRAO
+#define LOG_TEXTO_PADRAO 0
+#endif
+
+#ifndef RASTRO_PADRAO
+#define RASTRO_PADRAO 0
+#endif
+
+#ifndef RASTRO_TEMPO_REAL
+#define RASTRO_TEMPO_REAL 0
+#endif
+
+#ifndef NUM_ESTEIRAS
+#define NUM_ESTEIRAS 1
+#endif
+
+typedef struct {
+    char texto[96];
+    bool fim_do_boot; // Sem texto: o núcleo 0 marcou a última fase do boot
+} mensagem_t;
+
+#define TAMANHO_FILA_MENSAGENS 16
+
+// Mapa de pinos e periféricos de uma esteira
+#define SEM_EIXO 0xFF // Entrada ADC ausente: o eixo fica sempre no centro
+
+typedef struct {
+    uint8_t joystick_x;      // Entrada ADC do eixo X (velocidade)
+    uint8_t joystick_y;      // Entrada ADC do eixo Y (inclinação) ou SEM_EIXO
+    uint8_t botao_joystick;  // Pino digital do botão do joystick
+    uint8_t botao_a;         // Finaliza o treino
+    uint8_t botao_b;         // Alerta de emergência
+    uint8_t buzzer;          // PWM para gerar tom
+    uint8_t led_azul;        // PWM: progresso do treino
+    uint8_t led_vermelho;    // Digital: emergência
+    i2c_inst_t *i2c;         // Barramento do display OLED
+    uint8_t i2c_sda;
+    uint8_t i2c_scl;
+    uint8_t endereco_oled;
+} esteira_config_t;
+
+// A esteira 0 é a BitDogLab. A esteira 1 usa o conector i2c0 (GPIO 16/17)
+// e o último ADC livre (GPIO 28), só para a velocidade: o RP2040 tem três
+// entradas ADC externas, o que limita o firmware a duas esteiras. Um
+// segundo display no mesmo barramento também serve, com endereço 0x3D.
+static const esteira_config_t config_esteiras[] = {
+    { 0, 1, 22, 5, 6, 21, 12, 13, i2c1, 14, 15, 0x3C },
+#if NUM_ESTEIRAS > 1
+    { 2, SEM_EIXO, 18, 19, 20, 10, 7, 8, i2c0, 16, 17, 0x3C },
+#endif
+};
+
+_Static_assert(NUM_ESTEIRAS >= 1 && NUM_ESTEIRAS == sizeof(config_esteiras) / sizeof(config_esteiras[0]),
+               "NUM_ESTEIRAS sem mapa de pinos");
+_Static_assert(NUM_ESTEIRAS <= RECORDER_LANES, "esteiras além do gravador");
+
+// Índices dos botões de cada esteira no módulo de entrada; o botão
+// esteira * BOTOES_POR_ESTEIRA + id é o id da esteira
+enum { ID_JOYSTICK, ID_BOTAO_A, ID_BOTAO_B, BOTOES_POR_ESTEIRA };
+
+_Static_assert(NUM_ESTEIRAS * BOTOES_POR_ESTEIRA <= INPUT_MAX_BUTTONS, "botões demais");
+_Static_assert(NUM_ESTEIRAS * 2 <= PATTERN_MAX_CHANNELS, "canais de padrão demais");
+
+// Períodos das tarefas do núcleo 0
+#define PERIODO_ENTRADA_US 10000  // 100 Hz: botões e sequência de fim de treino
+#define PERIODO_FISICA_US 20000   // 50 Hz: distância, estatísticas e fim do tempo
+#define PERIODO_RAMPA_US 500000   // 2 Hz: joystick, passo de velocidade/inclinação e amostra gravada
+#define PERIODO_DISPLAY_US 100000 // 10 Hz: fotografia para o display e a telemetria
+#define PERIODO_LED_US 1000000    // 1 Hz: brilho do LED azul
+#define PERIODO_WATCHDOG_US 100000 // 10 Hz: alimenta o watchdog
+
+enum { TAREFA_ENTRADA, TAREFA_FISICA, TAREFA_RAMPA, TAREFA_DISPLAY, TAREFA_LED, TAREFA_WATCHDOG };
+
+// Cobre a gravação de um setor da flash (~50 ms, núcleo 0 parado) com folga
+#define WATCHDOG_TIMEOUT_MS 1000
+
+// Economia de energia sem treino, sem finalização pendente e sem emergência
+#define OCIOSO_ESCURECER_MS 30000  // Contraste mínimo
+#define OCIOSO_DORMIR_MS 120000    // Display desligado, clock reduzido e núcleo 0 dormindo
+#define ESPERA_DISPLAY_DORMIR_MS 100
+#define CONTRASTE_NORMAL 0xFF      // O mesmo de ssd1306_config()
+#define CONTRASTE_ESCURO 0x01
+
+// Padrões de som e pisca, tocados por alarmes sem bloquear o loop
+#define TOM_BEEP_HZ 2000
+
+static const pattern_step_t passo_inicio[] = { { 1000, 500 } };
+static const pattern_step_t passo_pausa[] = { { 2000, 0 } };
+static const pattern_step_t passo_fim[] = { { 500, 300 } };
+static const pattern_step_t passo_emergencia[] = { { 500, 500 } };
+
+static const pattern_t beeps_inicio = { passo_inicio, 1, 2, TOM_BEEP_HZ };         // 2 beeps de 1s
+static const pattern_t beep_pausa = { passo_pausa, 1, 1, TOM_BEEP_HZ };            // 1 beep de 2s
+static const pattern_t beeps_fim = { passo_fim, 1, 4, TOM_BEEP_HZ };               // 4 beeps curtos
+static const pattern_t alerta_emergencia = { passo_emergencia, 1, PATTERN_FOREVER, TOM_BEEP_HZ };
+
+// Captura contínua dos eixos do joystick: 1 kHz por eixo, média de 16 amostras
+// (62,5 Hz por eixo) e IIR de primeira ordem por cima. As entradas são as
+// das esteiras, preenchidas em main().
+static adc_stream_config_t config_joystick = {
+    .sample_rate_hz = 1000,
+    .oversample_log2 = 4,
+    .filter = ADC_FILTER_IIR,
+    .iir_shift = 2,
+};
+bool adc_continuo = false;
+
+// Sequência de telas ao finalizar o treino (médias -> mensagem -> LED apagado)
+enum { FINALIZACAO_NENHUMA, FINALIZACAO_MEDIAS, FINALIZACAO_MENSAGEM };
+
+typedef struct {
+    const esteira_config_t *config;
+    uint8_t indice;
+
+    // Treino (núcleo 0)
+    treino_t treino; // Velocidade, inclinação, distância e somas em ponto fixo
+    bool em_andamento;
+    bool pausado;
+    bool emergencia_ativa;
+    absolute_time_t tempo_inicio_treino;
+    absolute_time_t tempo_pausa_inicio;
+    int etapa_finalizacao;
+    absolute_time_t prazo_finalizacao;
+    int canal_buzzer;
+    int canal_led_vermelho;
+    uint32_t tick_controle;
+
+    // Canal núcleo 0 -> núcleo 1
+    seqlock_t trava_telemetria;
+    telemetria_t telemetria_publicada;
+
+    // Display (usado só pelo núcleo 1)
+    ssd1306_t ssd;
+    widget_state_t widgets;
+    grafico_t grafico; // Histórico de velocidade e inclinação
+    uint32_t versao_exibida;
+    uint32_t tick_impresso;
+    energia_t energia_aplicada;
+    uint32_t recuperacoes_vistas; // Recuperações do barramento já tratadas
+} esteira_t;
+
+esteira_t esteiras[NUM_ESTEIRAS];
 int tempo_treino_minutos = 1; // Tempo de treino fixo em 1 minuto
-int indice_inclinacao = 0; // Índice da inclinação inicial
-uint32_t tempo_ultimo_clique_botao_A = 0; // Tempo do último clique no botão A
-bool debounce_botao_A = false; // Flag para debouncing do botão A
-
-// Variável para o display OLED
-ssd1306_t ssd;
 
-// Variável para controle do estado de emergência
-bool emergencia_ativa = false;
+queue_t fila_mensagens;
+
+// Estado de energia (núcleo 0) e medição do despertar (lida pelo núcleo 1)
+energia_t energia_display = ENERGIA_ATIVO;
+absolute_time_t ultima_atividade;
+uint32_t bordas_ao_dormir;
+uint32_t clock_normal_khz;
+volatile bool display_dormindo = false; // Confirmação do núcleo 1
+volatile uint32_t borda_despertar_us;
+volatile uint32_t latencia_clock_us;
+
+// Rastro das entradas do controle (núcleo 0; os blocos saem pelo núcleo 1)
+#define TAMANHO_FILA_RASTRO 4
+enum { RASTRO_NENHUM, RASTRO_INICIAR, RASTRO_PARAR };
+enum { CONFIG_RASTRO_MINUTOS, CONFIG_RASTRO_ESTEIRAS };
+
+uint64_t instante_us; // Instante do passo de controle atual
+uint8_t tarefa_do_passo;
+bool passo_gravado;
+volatile int pedido_rastro = RASTRO_NENHUM; // Comando recebido pelo núcleo 1
+bool capturando = false;
+trace_writer_t escritor_rastro;
+queue_t fila_rastro;
+uint32_t blocos_rastro;
+uint32_t blocos_rastro_perdidos;
+
+// Reprodução: captura a reproduzir (carregada pelo host ou embutida no
+// firmware) e o leitor dela
+const uint8_t *rastro_reproduzir = NULL;
+size_t tamanho_rastro_reproduzir;
+bool rastro_tempo_real = RASTRO_TEMPO_REAL;
+bool reproduzindo = false;
+bool rastro_inconsistente = false;
+trace_reader_t leitor_rastro;
+
+#if RASTRO_EMBUTIDO
+extern const uint8_t rastro_embutido[];
+extern const size_t tamanho_rastro_embutido;
+#endif
+
+// Voltas do laço do núcleo 1, conferidas antes de alimentar o watchdog
+volatile uint32_t voltas_nucleo1;
+uint32_t voltas_vistas;
+
+// Checkpoint do estado dos treinos para a retomada depois do watchdog
+#define RETOMADA_MAGICA 0x52544D41 // "RTMA"
+
+typedef struct {
+    treino_t treino;
+    bool em_andamento;
+    bool pausado;
+    bool emergencia_ativa;
+    int etapa_finalizacao;
+    uint32_t tick_controle;
+    tela_t tela;
+    // Instantes no relógio do boot em que o checkpoint foi gravado
+    uint64_t inicio_treino_us;
+    uint64_t pausa_inicio_us;
+    uint64_t prazo_finalizacao_us;
+} retomada_esteira_t;
+
+typedef struct {
+    uint32_t magica;
+    uint32_t sequencia;     // 0 enquanto a cópia está sendo gravada
+    uint64_t instante_us;   // Passo de controle do checkpoint
+    int tempo_treino_minutos;
+    retomada_esteira_t esteiras[NUM_ESTEIRAS];
+    uint32_t sequencia_fim; // Igual a sequencia quando a cópia terminou
+} retomada_t;
+
+// Duas cópias alternadas: um reset no meio da gravação de uma deixa a outra
+// inteira. Ficam fora do .bss, que o boot zera.
+retomada_t __uninitialized_ram(retomadas)[2];
+uint32_t sequencia_retomada;
 
 // Função para configurar PWM no LED azul
 void configure_pwm(uint gpio) {
@@ -67,381 +307,1273 @@ void configure_pwm(uint gpio) {
 // Função para ajustar o brilho do LED azul
 void set_brightness(uint gpio, uint8_t percent) {
     if (percent > 100) percent = 100;
-    uint16_t value = (uint16_t)((percent / 100.0) * 65535);
+    uint16_t value = (uint16_t)((percent * 65535u) / 100);
     pwm_set_gpio_level(gpio, value);
 }
 
-// Função para emitir beeps com o buzzer
-void emitir_beeps(int quantidade, int duracao, int intervalo) {
-    for (int i = 0; i < quantidade; i++) {
-        gpio_put(BUZZER, 1);
-        sleep_ms(duracao);
-        gpio_put(BUZZER, 0);
-        sleep_ms(intervalo);
+// Envia uma linha de texto para o núcleo 1 imprimir; se a fila estiver
+// cheia a mensagem é descartada em vez de bloquear o controle. Com várias
+// esteiras, as mensagens de uma esteira (e != NULL) levam o número dela.
+void registrar(const esteira_t *e, const char *formato, ...) {
+    mensagem_t mensagem;
+    mensagem.fim_do_boot = false;
+    int n = 0;
+    if (NUM_ESTEIRAS > 1 && e != NULL) {
+        n = snprintf(mensagem.texto, sizeof(mensagem.texto), "[esteira %u] ", e->indice);
     }
+    va_list args;
+    va_start(args, formato);
+    vsnprintf(mensagem.texto + n, sizeof(mensagem.texto) - n, formato, args);
+    va_end(args);
+    // Na reprodução a saída é o resultado: espera o núcleo 1 em vez de descartar
+    while (!queue_try_add(&fila_mensagens, &mensagem) && reproduzindo) {
+        best_effort_wfe_or_timeout(make_timeout_time_us(1000));
+    }
+    __sev();
 }
 
-// Função para ativar/desativar o alerta de emergência
-void pedir_ajuda_emergencia() {
-    emergencia_ativa = !emergencia_ativa; // Alterna o estado de emergência
-
-    if (emergencia_ativa) {
-        printf("Alerta de emergência ativado!\n");
-        while (emergencia_ativa) {
-            gpio_put(LED_VERMELHO, 1); // Liga o LED vermelho
-            gpio_put(BUZZER, 1);       // Liga o buzzer
-            sleep_ms(500);             // Espera 500ms
-            gpio_put(LED_VERMELHO, 0); // Desliga o LED vermelho
-            gpio_put(BUZZER, 0);       // Desliga o buzzer
-            sleep_ms(500);             // Espera 500ms
-
-            // Verifica se o botão B foi pressionado novamente para desativar o alerta
-            if (!gpio_get(BOTAO_B)) {
-                emergencia_ativa = false;
-                printf("Alerta de emergência desativado!\n");
-            }
+// Instante do passo de controle atual: o controle não lê o relógio direto,
+// para que a reprodução de um rastro dê exatamente o mesmo resultado
+absolute_time_t agora() {
+    return from_us_since_boot(instante_us);
+}
+
+void gravar_rastro(trace_kind_t tipo, uint canal, int32_t valor) {
+    trace_event_t evento = { instante_us, valor, (uint8_t)tipo, (uint8_t)canal };
+    trace_block_t cheio;
+    if (trace_write(&escritor_rastro, &evento, &cheio)) {
+        if (queue_try_add(&fila_rastro, &cheio)) {
+            blocos_rastro++;
+        } else {
+            blocos_rastro_perdidos++; // O leitor para no buraco da sequência
         }
     }
 }
 
+// Grava o passo atual no rastro, uma vez, antes da primeira entrada dele
+void gravar_passo() {
+    if (capturando && !passo_gravado) {
+        passo_gravado = true;
+        gravar_rastro(TRACE_STEP, tarefa_do_passo, 0);
+    }
+}
+
+// Grava uma entrada consumida pelo passo atual
+void gravar_entrada(trace_kind_t tipo, uint canal, int32_t valor) {
+    if (capturando) {
+        gravar_passo();
+        gravar_rastro(tipo, canal, valor);
+    }
+}
+
+// Começa um passo de controle, fixando o instante que ele vê (na reprodução,
+// o do rastro). Os passos "sempre" entram no rastro mesmo sem consumir
+// entradas; os outros só se consumirem alguma ou mudarem o estado.
+void HOT_FUNC(comecar_passo)(uint8_t tarefa, bool sempre) {
+    if (!reproduzindo) {
+        instante_us = time_us_64();
+    }
+    tarefa_do_passo = tarefa;
+    passo_gravado = false;
+    if (sempre) {
+        gravar_passo();
+    }
+}
+
+int calcular_tempo_decorrido(const esteira_t *e);
+void atualizar_tarefas();
+
+// Publica uma fotografia do estado atual da esteira para o núcleo 1
+void HOT_FUNC(publicar_telemetria)(esteira_t *e, tela_t tela) {
+    telemetria_t t = {
+        .tick = e->tick_controle,
+        .tela = tela,
+        .velocidade = e->treino.velocidade,
+        .inclinacao = e->treino.inclinacao,
+        .distancia_mm = treino_distancia_mm(&e->treino),
+        .velocidade_media = treino_velocidade_media(&e->treino),
+        .inclinacao_media = treino_inclinacao_media(&e->treino),
+        .tempo_decorrido_s = calcular_tempo_decorrido(e),
+        .instante_ms = to_ms_since_boot(agora()),
+        .em_andamento = e->em_andamento,
+        .pausado = e->pausado,
+        .emergencia = e->emergencia_ativa,
+        .energia = energia_display,
+    };
+
+    seqlock_write_begin(&e->trava_telemetria);
+    e->telemetria_publicada = t;
+    seqlock_write_end(&e->trava_telemetria);
+    __sev(); // Acorda o núcleo 1
+}
+
+// Copia a última fotografia publicada; retorna a versão (sequência do seqlock)
+uint32_t HOT_FUNC(ler_telemetria)(esteira_t *e, telemetria_t *t) {
+    uint32_t versao;
+    do {
+        versao = seqlock_read_begin(&e->trava_telemetria);
+        *t = e->telemetria_publicada;
+    } while (seqlock_read_retry(&e->trava_telemetria, versao));
+    return versao;
+}
+
+// Republica a tela atual após uma mudança de estado (início, pausa,
+// emergência), para que a telemetria registre a transição
+void publicar_estado(esteira_t *e) {
+    publicar_telemetria(e, e->telemetria_publicada.tela);
+}
+
+// Registros das sessões no gravador da flash (gravados pelo núcleo 1); um
+// treino reproduzido não é gravado de novo
+void gravar_registro(esteira_t *e, recorder_kind_t tipo) {
+    if (reproduzindo) {
+        return;
+    }
+    recorder_record_t registro = {
+        .kind = tipo,
+        .lane = e->indice,
+        .elapsed_s = (uint16_t)calcular_tempo_decorrido(e),
+        .speed = e->treino.velocidade,
+        .incline = e->treino.inclinacao,
+        .value = treino_distancia_mm(&e->treino),
+    };
+    if (tipo == RECORDER_SUMMARY) {
+        registro.speed = treino_velocidade_media(&e->treino);
+        registro.incline = treino_inclinacao_media(&e->treino);
+    }
+    recorder_push(&registro);
+}
+
+// Função para ativar/desativar o alerta de emergência
+void pedir_ajuda_emergencia(esteira_t *e) {
+    e->emergencia_ativa = !e->emergencia_ativa; // Alterna o estado de emergência
+
+    if (e->emergencia_ativa) {
+        registrar(e, "Alerta de emergência ativado!\n");
+        // LED vermelho e buzzer alternam a cada 500ms até o botão B ser pressionado de novo
+        pattern_stop(e->canal_buzzer);
+        pattern_play(e->canal_buzzer, &alerta_emergencia);
+        pattern_play(e->canal_led_vermelho, &alerta_emergencia);
+    } else {
+        pattern_stop(e->canal_buzzer);
+        pattern_stop(e->canal_led_vermelho);
+        registrar(e, "Alerta de emergência desativado!\n");
+    }
+    publicar_estado(e);
+}
+
 // Função para iniciar ou retomar o treino
-void iniciar_treino() {
-    if (!treino_pausado) {  // Apenas zera os valores se for um treino novo
-        printf("Treino de %d minutos iniciado!\n", tempo_treino_minutos);
-
-        printf("Iniciando novo treino...\n");
-        distancia_percorrida = 0.0;
-        soma_velocidade = 0.0;
-        soma_inclinacao = 0.0;
-        contador_medidas = 0;
-        velocidade_atual = 0.0;
-        indice_inclinacao = 0;
-        inclinacao_atual = inclinacao_niveis[indice_inclinacao];
-        tempo_inicio_treino = get_absolute_time();
+void iniciar_treino(esteira_t *e) {
+    if (!e->pausado) {  // Apenas zera os valores se for um treino novo
+        registrar(e, "Treino de %d minutos iniciado!\n", tempo_treino_minutos);
+
+        registrar(e, "Iniciando novo treino...\n");
+        e->tempo_inicio_treino = agora();
+        treino_reiniciar(&e->treino, to_us_since_boot(e->tempo_inicio_treino));
+        e->etapa_finalizacao = FINALIZACAO_NENHUMA; // Descarta telas pendentes do treino anterior
+        gravar_registro(e, RECORDER_START);
     } else {
-        printf("Retomando treino...\n");
-        int64_t tempo_pausa_ms = absolute_time_diff_us(tempo_pausa_inicio, get_absolute_time()) / 1000;
-        tempo_inicio_treino = delayed_by_ms(tempo_inicio_treino, tempo_pausa_ms);
+        registrar(e, "Retomando treino...\n");
+        int64_t tempo_pausa_ms = absolute_time_diff_us(e->tempo_pausa_inicio, agora()) / 1000;
+        // Soma modular: depois de um reinício pelo watchdog o início pode
+        // ficar antes do boot, onde delayed_by_ms() satura
+        e->tempo_inicio_treino =
+            from_us_since_boot(to_us_since_boot(e->tempo_inicio_treino) + (uint64_t)tempo_pausa_ms * 1000);
     }
 
-    emitir_beeps(2, 1000, 500);
-    treino_em_andamento = true;
-    treino_pausado = false;
-    tempo_anterior = get_absolute_time();  // Retoma a contagem de tempo corretamente
+    pattern_play(e->canal_buzzer, &beeps_inicio);
+    e->em_andamento = true;
+    e->pausado = false;
+    treino_retomar(&e->treino, instante_us);  // Retoma a contagem de tempo corretamente
+    publicar_estado(e);
+    atualizar_tarefas();
 }
 
-// Função para verificar e atualizar a intensidade do LED azul
-void atualizar_led_azul() {
-    if (treino_em_andamento) {
-        int64_t tempo_decorrido_ms = absolute_time_diff_us(tempo_inicio_treino, get_absolute_time()) / 1000;
-        int64_t tempo_total_ms = tempo_treino_minutos * 60 * 1000;
+// Integra o treino até agora e anuncia os km completos
+void HOT_FUNC(integrar_treino)(esteira_t *e) {
+    if (treino_integrar(&e->treino, instante_us)) {
+        registrar(e, "Km %lu: %u:%02u\n", (unsigned long)e->treino.km_completos,
+                  TREINO_MIN_SEG(e->treino.ultimo_km_ms));
+    }
+}
 
-        if (tempo_decorrido_ms >= tempo_total_ms) {
-            treino_em_andamento = false;
-            printf("Tempo de treino encerrado!\n");
-        }
+int64_t tempo_decorrido_ms(const esteira_t *e) {
+    return absolute_time_diff_us(e->tempo_inicio_treino, agora()) / 1000;
+}
 
-        int brilho = (tempo_decorrido_ms * 100) / tempo_total_ms;
-        set_brightness(LED_AZUL, brilho);
+// Função para verificar e atualizar a intensidade do LED azul
+void atualizar_led_azul(const esteira_t *e) {
+    int64_t tempo_total_ms = tempo_treino_minutos * 60 * 1000;
+    int brilho = (tempo_decorrido_ms(e) * 100) / tempo_total_ms;
+    set_brightness(e->config->led_azul, brilho);
+}
+
+// Encerra o treino quando o tempo programado acaba
+void verificar_fim_do_tempo(esteira_t *e) {
+    if (tempo_decorrido_ms(e) >= (int64_t)tempo_treino_minutos * 60 * 1000) {
+        gravar_registro(e, RECORDER_SUMMARY);
+        e->em_andamento = false;
+        set_brightness(e->config->led_azul, 100);
+        registrar(e, "Tempo de treino encerrado!\n");
+        atualizar_tarefas();
     }
 }
 
-void calcula_medias(){
-    // Cálculo das médias
-    float velocidade_media = contador_medidas > 0 ? soma_velocidade / contador_medidas : 0.0;
-    float inclinacao_media = contador_medidas > 0 ? soma_inclinacao / contador_medidas : 0.0;
+// Tempo em cada faixa do histograma, só as faixas ocupadas ("0:12s 10:3590s")
+void registrar_faixas(const esteira_t *e, const char *titulo, const estatistica_t *estat) {
+    char linha[sizeof(((mensagem_t *)0)->texto)];
+    int n = snprintf(linha, sizeof(linha), "%s:", titulo);
+    for (uint i = 0; i < ESTATISTICA_FAIXAS && n < (int)sizeof(linha); i++) {
+        uint32_t segundos = estatistica_faixa_s(estat, i);
+        if (segundos > 0) {
+            // Início da faixa, em unidades inteiras (km/h ou %)
+            n += snprintf(linha + n, sizeof(linha) - n, " %u:%lus", (unsigned)(i * estat->largura_faixa / 10),
+                          (unsigned long)segundos);
+        }
+    }
+    registrar(e, "%s\n", linha);
+}
 
-    // Imprimir as médias
-    printf("Velocidade média: %.1f km/h\n", velocidade_media);
-    printf("Inclinação média: %.1f%%\n", inclinacao_media);
+void calcula_medias(const esteira_t *e){
+    // Médias ponderadas pelo tempo, extremos e desvio padrão
+    const estatistica_t *v = &e->treino.estat_velocidade;
+    const estatistica_t *i = &e->treino.estat_inclinacao;
+
+    registrar(e, "Velocidade média: %u.%u km/h (mín %u.%u, máx %u.%u, desvio %u.%u)\n",
+              TREINO_DECIMOS(estatistica_media(v)), TREINO_DECIMOS(estatistica_minimo(v)),
+              TREINO_DECIMOS(estatistica_maximo(v)), TREINO_DECIMOS(estatistica_desvio(v)));
+    registrar(e, "Inclinação média: %u.%u%% (mín %u.%u, máx %u.%u, desvio %u.%u)\n",
+              TREINO_DECIMOS(estatistica_media(i)), TREINO_DECIMOS(estatistica_minimo(i)),
+              TREINO_DECIMOS(estatistica_maximo(i)), TREINO_DECIMOS(estatistica_desvio(i)));
+    if (e->treino.km_completos > 0) {
+        registrar(e, "Ritmo por km: melhor %u:%02u, pior %u:%02u (%lu km)\n", TREINO_MIN_SEG(e->treino.melhor_km_ms),
+                  TREINO_MIN_SEG(e->treino.pior_km_ms), (unsigned long)e->treino.km_completos);
+    }
+    registrar_faixas(e, "Tempo por velocidade (km/h)", v);
+    registrar_faixas(e, "Tempo por inclinação (%)", i);
 }
 
 // Função para pausar o treino
-void pausar_treino() {
-    printf("Treino pausado!\n");
-    emitir_beeps(1, 2000, 0); // 1 beep de 2s
-    printf("Distância percorrida: %.1f m\n", distancia_percorrida);
-    calcula_medias();  // Chama a função para calcular e imprimir as médias
-    treino_pausado = true;
-    tempo_pausa_inicio = get_absolute_time();
+void pausar_treino(esteira_t *e) {
+    integrar_treino(e); // Até o instante da pausa
+    registrar(e, "Treino pausado!\n");
+    pattern_play(e->canal_buzzer, &beep_pausa); // 1 beep de 2s
+    registrar(e, "Distância percorrida: %u.%u m\n",
+              TREINO_DECIMOS(TREINO_DECIMOS_METRO(treino_distancia_mm(&e->treino))));
+    calcula_medias(e);  // Chama a função para calcular e imprimir as médias
+    e->pausado = true;
+    e->tempo_pausa_inicio = agora();
+    publicar_estado(e);
+    atualizar_tarefas();
 }
 
 // Função para calcular o tempo de treino decorrido em segundos
-int calcular_tempo_decorrido() {
+int calcular_tempo_decorrido(const esteira_t *e) {
     int64_t tempo_decorrido_ms = 0;
 
-    if (treino_em_andamento) {
+    if (e->em_andamento) {
         // Se o treino está em andamento, calcula o tempo desde o início do treino
-        tempo_decorrido_ms = absolute_time_diff_us(tempo_inicio_treino, get_absolute_time()) / 1000;
-    } else if (treino_pausado) {
+        tempo_decorrido_ms = absolute_time_diff_us(e->tempo_inicio_treino, agora()) / 1000;
+    } else if (e->pausado) {
         // Se o treino está pausado, calcula o tempo até o momento da pausa
-        tempo_decorrido_ms = absolute_time_diff_us(tempo_inicio_treino, tempo_pausa_inicio) / 1000;
+        tempo_decorrido_ms = absolute_time_diff_us(e->tempo_inicio_treino, e->tempo_pausa_inicio) / 1000;
     }
 
     // Converte o tempo de milissegundos para segundos
     return (int)(tempo_decorrido_ms / 1000);
 }
 
-// Função para exibir a mensagem de treino finalizado
-void exibir_mensagem_finalizado() {
-    char buffer[32];
-    ssd1306_fill(&ssd, false); // Limpa o display (fundo escuro)
-
-    // Centraliza as palavras "TREINO", "EMBARCATECH" e "FINALIZADO" em três linhas
-    int mensagem_x = (128 - (11 * 8)) / 2; // Centraliza o texto (6 pixels por caractere)
+// Função para finalizar o treino
+void finalizar_treino(esteira_t *e) {
+    registrar(e, "Treino finalizado!\n");
+    set_brightness(e->config->led_azul, 100); // Alerta que a esteira está disponível para um novo usuário
+    pattern_play(e->canal_buzzer, &beeps_fim); // 4 beeps curtos
+    if (!e->pausado) {
+        integrar_treino(e); // Até o instante do fim
+    }
+    gravar_registro(e, RECORDER_SUMMARY);
+    e->em_andamento = false;
+    e->pausado = false;
+
+    registrar(e, "Resumo do treino:\n");
+    registrar(e, "Distância percorrida: %u.%u m\n",
+              TREINO_DECIMOS(TREINO_DECIMOS_METRO(treino_distancia_mm(&e->treino))));
+    calcula_medias(e);  // Chama a função para calcular e imprimir as médias
+
+    // Exibe as médias no display; a mensagem de finalizado vem 3 segundos depois
+    publicar_telemetria(e, TELA_MEDIAS);
+    e->etapa_finalizacao = FINALIZACAO_MEDIAS;
+    e->prazo_finalizacao = delayed_by_ms(agora(), 3000);
+    atualizar_tarefas();
+}
 
-    // Primeira linha: "TREINO"
-    ssd1306_draw_string(&ssd, "TREINO", mensagem_x, 10); // Posiciona "TREINO" na linha 10
+// Avança a sequência de telas do fim do treino quando o prazo da etapa vence
+void processar_finalizacao(esteira_t *e) {
+    if (e->etapa_finalizacao == FINALIZACAO_NENHUMA || absolute_time_diff_us(e->prazo_finalizacao, agora()) < 0) {
+        return;
+    }
+    gravar_passo(); // A reprodução precisa passar por este instante
 
-    // Segunda linha: "EMBARCATECH"
-    ssd1306_draw_string(&ssd, "EMBARCATECH", mensagem_x, 26); // Posiciona "EMBARCATECH" na linha 26
+    if (e->etapa_finalizacao == FINALIZACAO_MEDIAS) {
+        // Exibe a mensagem de treino finalizado
+        publicar_telemetria(e, TELA_FINALIZADO);
+        e->etapa_finalizacao = FINALIZACAO_MENSAGEM;
+        e->prazo_finalizacao = delayed_by_ms(agora(), 500); // Espera 500ms antes de desligar o LED
+    } else {
+        set_brightness(e->config->led_azul, 0);
+        e->etapa_finalizacao = FINALIZACAO_NENHUMA;
+    }
+}
 
-    // Terceira linha: "FINALIZADO"
-    ssd1306_draw_string(&ssd, "FINALIZADO", mensagem_x, 42); // Posiciona "FINALIZADO" na linha 42
+// Leitura de um eixo gravada no rastro, na ordem em que o passo a consumiu
+uint16_t ler_eixo_rastro(uint entrada) {
+    trace_event_t evento;
+    if (!trace_peek(&leitor_rastro, &evento) || evento.kind != TRACE_ADC || evento.channel != entrada) {
+        rastro_inconsistente = true;
+        return 2048;
+    }
+    trace_next(&leitor_rastro);
+    return (uint16_t)evento.value;
+}
 
-    ssd1306_send_data(&ssd);
+// Lê um eixo do joystick: valor filtrado da captura contínua ou, se ela não
+// pôde ser iniciada, uma conversão avulsa
+uint16_t HOT_FUNC(ler_eixo_joystick)(uint entrada) {
+    if (entrada == SEM_EIXO) {
+        return 2048; // Centro: o nível não muda
+    }
+    if (reproduzindo) {
+        return ler_eixo_rastro(entrada);
+    }
+    uint32_t sonda = probe_start();
+    uint16_t valor = 2048; // Centro, enquanto não há amostras
+    if (adc_continuo) {
+        adc_stream_read(entrada, &valor, NULL);
+    } else {
+        adc_select_input(entrada);
+        valor = adc_read();
+    }
+    probe_record(PROBE_ADC, sonda);
+    gravar_entrada(TRACE_ADC, entrada, valor);
+    return valor;
 }
 
-// Função para finalizar o treino
-void finalizar_treino() {
-    printf("Treino finalizado!\n");
-    set_brightness(LED_AZUL, 100); // Alerta que a esteira está disponível para um novo usuário
-    emitir_beeps(4, 500, 300); // 4 beeps curtos
-    treino_em_andamento = false;
-    treino_pausado = false;
+// Função para mapear leitura do ADC para um valor desejado
+float mapear_adc(uint16_t valor_adc, float min_saida, float max_saida) {
+    return min_saida + (max_saida - min_saida) * (valor_adc / 4095.0);
+}
 
-    printf("Resumo do treino:\n");
-    printf("Distância percorrida: %.1f m\n", distancia_percorrida);
-    calcula_medias();  // Chama a função para calcular e imprimir as médias
+// Formato da saída na serial; só o núcleo 1 lê e altera
+bool log_texto = LOG_TEXTO_PADRAO;
+// Gráfico no lugar da tela de treino; também só do núcleo 1
+bool mostrar_grafico = false;
+
+// Envia um registro binário da fotografia, sem a tradução de '\n' da stdio
+void enviar_telemetria(const esteira_t *e, const telemetria_t *t) {
+    telemetry_record_t registro = {
+        .timestamp_ms = t->instante_ms,
+        .tick = t->tick,
+        .distance_mm = t->distancia_mm,
+        .speed = t->velocidade,
+        .incline = t->inclinacao,
+        .elapsed_s = (uint16_t)t->tempo_decorrido_s,
+        .screen = (uint8_t)t->tela,
+        .lane = e->indice,
+        .flags = (t->em_andamento ? TELEMETRY_FLAG_RUNNING : 0) |
+                 (t->pausado ? TELEMETRY_FLAG_PAUSED : 0) |
+                 (t->emergencia ? TELEMETRY_FLAG_EMERGENCY : 0),
+    };
+    uint8_t quadro[TELEMETRY_FRAME_MAX];
+    size_t tamanho = telemetry_encode(&registro, quadro);
+    for (size_t i = 0; i < tamanho; i++) {
+        putchar_raw(quadro[i]);
+    }
+}
 
-    // Exibe as médias no display
-    exibir_medias_display();
+// Envia um bloco do rastro de entradas, também sem a tradução de '\n'
+void enviar_rastro(const trace_block_t *bloco) {
+    uint8_t quadro[TRACE_FRAME_MAX];
+    size_t tamanho = trace_frame(bloco, quadro);
+    for (size_t i = 0; i < tamanho; i++) {
+        putchar_raw(quadro[i]);
+    }
+}
 
-    // Aguarda 3 segundos
-    sleep_ms(3000);
+// Comandos pela serial (USB/UART), lidos pelo núcleo 1, um por linha:
+//   sondas        - imprime as sondas de latência (CSV)
+//   sondas zerar  - zera as sondas
+//   sessoes       - lista as sessões gravadas na flash (CSV)
+//   sessao <n>    - envia as amostras da sessão n (CSV)
+//   log texto     - troca a telemetria binária pelo log legível
+//   log binario   - volta à telemetria binária
+//   tarefas       - imprime os prazos perdidos e o jitter das tarefas (CSV)
+//   tarefas zerar - zera os contadores das tarefas
+//   boot          - imprime as fases do boot (CSV; cmake -DEMBARCATECH_PERFIL_BOOT=ON)
+//   i2c           - imprime a velocidade e as falhas do barramento de cada display (CSV)
+//   rastro iniciar - envia as entradas do controle num rastro binário
+//   rastro parar  - encerra o rastro
+//   tela grafico  - mostra o gráfico de velocidade e inclinação durante o treino
+//   tela treino   - volta à tela de treino com os valores
+#define TAMANHO_LINHA_COMANDO 32
+
+// As listagens podem ser longas: cada linha conta como volta do núcleo 1
+void imprimir_sessao(const recorder_session_t *sessao, void *contexto) {
+    (void)contexto;
+    voltas_nucleo1++;
+    const recorder_record_t *r = &sessao->summary;
+    printf("%lu,%u,%lu,%d,%u,%u.%u,%u.%u,%u.%u\n", (unsigned long)sessao->id, sessao->lane,
+           (unsigned long)sessao->samples, sessao->complete, r->elapsed_s,
+           TREINO_DECIMOS(TREINO_DECIMOS_METRO(r->value)), TREINO_DECIMOS(r->speed), TREINO_DECIMOS(r->incline));
+}
 
-    // Exibe a mensagem de treino finalizado
-    exibir_mensagem_finalizado();
+void imprimir_amostra(const recorder_record_t *r, void *contexto) {
+    (void)contexto;
+    voltas_nucleo1++;
+    if (r->kind == RECORDER_SAMPLE) {
+        printf("%u,%u.%u,%u.%u,%u.%u\n", r->elapsed_s, TREINO_DECIMOS(r->speed), TREINO_DECIMOS(r->incline),
+               TREINO_DECIMOS(TREINO_DECIMOS_METRO(r->value)));
+    }
+}
 
-    sleep_ms(500); // Espera 500ms antes de desligar o LED
-    set_brightness(LED_AZUL, 0);
+void executar_comando(const char *linha) {
+    unsigned numero;
+    if (strcmp(linha, "sessoes") == 0) {
+        printf("sessao,esteira,amostras,completa,tempo_s,distancia_m,velocidade_media,inclinacao_media\n");
+        recorder_list(imprimir_sessao, NULL);
+    } else if (sscanf(linha, "sessao %u", &numero) == 1) {
+        printf("tempo_s,velocidade_kmh,inclinacao_pct,distancia_m\n");
+        if (!recorder_stream(numero, imprimir_amostra, NULL)) {
+            printf("Sessão %u não encontrada\n", numero);
+        }
+    } else if (strcmp(linha, "log texto") == 0) {
+        log_texto = true;
+    } else if (strcmp(linha, "log binario") == 0) {
+        log_texto = false;
+    } else if (strcmp(linha, "sondas") == 0) {
+        probe_print();
+    } else if (strcmp(linha, "sondas zerar") == 0) {
+        probe_reset_all();
+        printf("Sondas zeradas\n");
+    } else if (strcmp(linha, "tarefas") == 0) {
+        scheduler_print();
+    } else if (strcmp(linha, "tarefas zerar") == 0) {
+        scheduler_reset_stats();
+        printf("Tarefas zeradas\n");
+    } else if (strcmp(linha, "boot") == 0) {
+        boot_profile_print();
+    } else if (strcmp(linha, "i2c") == 0) {
+        printf("esteira,velocidade_khz,erros,recuperacoes\n");
+        for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+            const ssd1306_t *ssd = &esteiras[i].ssd;
+            printf("%u,%u,%lu,%lu\n", i, ssd1306_bus_baudrate(ssd) / 1000, (unsigned long)ssd->bus_errors,
+                   (unsigned long)ssd->bus_recoveries);
+        }
+    } else if (strcmp(linha, "tela grafico") == 0) {
+        mostrar_grafico = true;
+    } else if (strcmp(linha, "tela treino") == 0) {
+        mostrar_grafico = false;
+    } else if (strcmp(linha, "rastro iniciar") == 0) {
+        pedido_rastro = RASTRO_INICIAR; // Atendido pelo núcleo 0 no próximo passo de entrada
+    } else if (strcmp(linha, "rastro parar") == 0) {
+        pedido_rastro = RASTRO_PARAR;
+    } else if (linha[0] != '\0') {
+        printf("Comando desconhecido: %s\n", linha);
+    }
 }
 
-// Função para mapear leitura do ADC para um valor desejado
-float mapear_adc(uint16_t valor_adc, float min_saida, float max_saida) {
-    return min_saida + (max_saida - min_saida) * (valor_adc / 4095.0);
+// Consome os caracteres disponíveis sem bloquear, montando a linha atual
+void ler_comandos_serial() {
+    static char linha[TAMANHO_LINHA_COMANDO];
+    static size_t tamanho = 0;
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == '\r' || c == '\n') {
+            linha[tamanho] = '\0';
+            executar_comando(linha);
+            tamanho = 0;
+        } else if (tamanho < sizeof(linha) - 1) {
+            linha[tamanho++] = (char)c;
+        }
+    }
 }
 
-// Função para atualizar o display OLED com as informações do treino
-void atualizar_display_treino() {
-    char buffer[32];
-    ssd1306_fill(&ssd, false); // Fundo escuro (todos os pixels desligados)
+// Chamado pela stdio quando chegam caracteres: acorda o núcleo 1 do __wfe()
+void avisar_serial(void *param) {
+    (void)param;
+    __sev();
+}
 
-    // Centraliza a palavra "EMBARCATECH" na primeira linha
-    int embarcatech_length = 11; // Número de caracteres em "EMBARCATECH"
-    int embarcatech_x = (128 - (embarcatech_length * 8)) / 2; // Centraliza o texto (6 pixels por caractere)
-    ssd1306_draw_string(&ssd, "EMBARCATECH", embarcatech_x, 2); // Centralizado na primeira linha (fonte clara)
+// Aplica ao display da esteira o estado de energia pedido na fotografia
+void aplicar_energia_display(esteira_t *e, energia_t energia) {
+    energia_t anterior = e->energia_aplicada;
+    e->energia_aplicada = energia;
+    if (energia == ENERGIA_DORMINDO) {
+        ssd1306_display_on(&e->ssd, false);
+        return;
+    }
 
-    // Linha horizontal abaixo do cabeçalho
-    ssd1306_line(&ssd, 0, 16, 128, 16, true); // Linha horizontal (fonte clara)
+    ssd1306_set_contrast(&e->ssd, energia == ENERGIA_ESCURO ? CONTRASTE_ESCURO : CONTRASTE_NORMAL);
+    if (anterior == ENERGIA_DORMINDO) {
+        ssd1306_display_on(&e->ssd, true);
+        probe_record(PROBE_WAKE, borda_despertar_us);
+        if (log_texto) {
+            if (NUM_ESTEIRAS > 1) {
+                printf("[esteira %u] ", e->indice);
+            }
+            printf("Despertar: clock em %lu us, display em %lu us\n", (unsigned long)latencia_clock_us,
+                   (unsigned long)(time_us_32() - borda_despertar_us));
+        }
+    }
+}
 
-    // Exibe a velocidade atual
-    snprintf(buffer, sizeof(buffer), "Vel.: %.1f Km/h", velocidade_atual);
-    ssd1306_draw_string(&ssd, buffer, 0, 20); // Fonte clara
+// Inicializa o barramento (o primeiro display de cada porta) e o display da
+// esteira; o barramento fica em 1 MHz se todos os displays dele respondem
+void iniciar_display(esteira_t *e) {
+    const esteira_config_t *c = e->config;
+    ssd1306_init(&e->ssd, 128, 64, false, c->endereco_oled, c->i2c);
+    ssd1306_bus_init(&e->ssd, c->i2c_sda, c->i2c_scl);
+    boot_profile_mark(BOOT_I2C);
+
+    grafico_reiniciar(&e->grafico);
+    ssd1306_config(&e->ssd);
+    boot_profile_mark(BOOT_SSD1306_CONFIG);
+    ssd1306_fill(&e->ssd, false);
+    ssd1306_send_data(&e->ssd);
+    ssd1306_dma_init(&e->ssd); // A IRQ da DMA fica neste núcleo; sem canal livre, o envio é bloqueante
+    boot_profile_mark(BOOT_FIRST_FRAME); // O primeiro quadro é a tela limpa
+}
 
-    // Exibe a inclinação atual
-    snprintf(buffer, sizeof(buffer), "Inclin.: %.1f%%", inclinacao_atual);
-    ssd1306_draw_string(&ssd, buffer, 0, 36); // Fonte clara
+// Outro display no mesmo barramento ainda está enviando um quadro por DMA
+bool barramento_ocupado(const esteira_t *e) {
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        esteira_t *outra = &esteiras[i];
+        if (outra != e && outra->config->i2c == e->config->i2c && ssd1306_busy(&outra->ssd)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Exibe a distância percorrida
-    snprintf(buffer, sizeof(buffer), "Distan.: %.1f m", distancia_percorrida);
-    ssd1306_draw_string(&ssd, buffer, 0, 52); // Fonte clara
+// Imprime ou envia a fotografia nova da esteira e atualiza o display dela
+void HOT_FUNC(atender_display)(esteira_t *e) {
+    // Com o barramento ocupado a fotografia fica para a próxima volta: a IRQ
+    // da DMA que termina o outro quadro acorda este núcleo
+    if (barramento_ocupado(e)) {
+        return;
+    }
+    // Enquanto o gráfico rola, o painel anda sozinho: nada vai para ele
+    if (e->grafico.rolando) {
+        if (!time_reached(e->grafico.fim_rolagem)) {
+            return;
+        }
+        grafico_concluir_rolagem(&e->ssd, &e->grafico);
+    }
+    // Um barramento em falha é recuperado na próxima transferência: sem
+    // fotografia nova, o flush faz a tentativa e, depois dela, reenvia o
+    // quadro inteiro. Dormindo não, que o clock do I2C está reduzido.
+    if ((e->ssd.bus_fault || e->ssd.bus_recoveries != e->recuperacoes_vistas) &&
+        e->energia_aplicada != ENERGIA_DORMINDO) {
+        ssd1306_flush(&e->ssd);
+        if (e->ssd.bus_recoveries != e->recuperacoes_vistas) {
+            e->recuperacoes_vistas = e->ssd.bus_recoveries;
+            if (log_texto) {
+                if (NUM_ESTEIRAS > 1) {
+                    printf("[esteira %u] ", e->indice);
+                }
+                printf("Display: barramento I2C recuperado (%lu erros, %lu recuperações)\n",
+                       (unsigned long)e->ssd.bus_errors, (unsigned long)e->ssd.bus_recoveries);
+            }
+        }
+    }
 
-    ssd1306_send_data(&ssd);
+    telemetria_t t;
+    uint32_t versao = ler_telemetria(e, &t);
+    if (versao == e->versao_exibida) {
+        return;
+    }
+    e->versao_exibida = versao;
+    if (!log_texto) {
+        enviar_telemetria(e, &t);
+    } else if (t.tela == TELA_TREINO && t.tick != e->tick_impresso) {
+        e->tick_impresso = t.tick;
+        if (NUM_ESTEIRAS > 1) {
+            printf("[esteira %u] ", e->indice);
+        }
+        printf("Velocidade: %u.%u km/h | Inclinação: %u.%u%% | Distância: %u.%u m\n",
+               TREINO_DECIMOS(t.velocidade), TREINO_DECIMOS(t.inclinacao),
+               TREINO_DECIMOS(TREINO_DECIMOS_METRO(t.distancia_mm)));
+    }
+    if (t.energia != e->energia_aplicada) {
+        aplicar_energia_display(e, t.energia);
+    }
+    if (t.tela == TELA_TREINO) {
+        grafico_amostrar(&e->grafico, t.tempo_decorrido_s, t.velocidade, t.inclinacao);
+    }
+    if (t.energia == ENERGIA_DORMINDO) {
+        return;
+    }
+    if (mostrar_grafico && t.tela == TELA_TREINO) {
+        renderizar_grafico(&e->ssd, &e->widgets, &e->grafico, &t);
+    } else {
+        renderizar_tela(&e->ssd, &e->widgets, &t);
+    }
 }
 
-// Função para exibir as médias no display quando o treino é pausado ou finalizado
-void exibir_medias_display() {
-    char buffer[32];
-    ssd1306_fill(&ssd, false);
-
-    // Cálculo das médias
-    float velocidade_media = contador_medidas > 0 ? soma_velocidade / contador_medidas : 0.0;
-    float inclinacao_media = contador_medidas > 0 ? soma_inclinacao / contador_medidas : 0.0;
+// Núcleo 1: dono dos displays e da stdio. Acorda com o __sev() do núcleo 0,
+// esvazia a fila de mensagens e redesenha quando há fotografia nova.
+void nucleo1_main() {
+    boot_profile_begin();
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        iniciar_display(&esteiras[i]);
+    }
 
-    // Desenha a tabela
-    ssd1306_rect(&ssd, 0, 0, 128, 64, true, false); // Borda da tabela
-    ssd1306_line(&ssd, 55, 16, 55, 64, true); // Linha vertical (começa após a primeira linha)
-    ssd1306_line(&ssd, 0, 16, 128, 16, true); // Linha horizontal abaixo do cabeçalho
+    stdio_set_chars_available_callback(avisar_serial, NULL);
 
-    // Centraliza a palavra "EMBARCATECH" na primeira linha
-    int embarcatech_length = 11; // Número de caracteres em "EMBARCATECH"
-    int embarcatech_x = (128 - (embarcatech_length * 8)) / 2; // Centraliza o texto (6 pixels por caractere)
-    ssd1306_draw_string(&ssd, "EMBARCATECH", embarcatech_x, 2); // Centralizado na primeira linha
+    uint primeira = 0;
+    while (true) {
+        voltas_nucleo1++; // Sinal de vida para o watchdog
+        mensagem_t mensagem;
+        while (queue_try_remove(&fila_mensagens, &mensagem)) {
+            if (mensagem.fim_do_boot) {
+                boot_profile_print(); // Na UART; pela USB, com o comando "boot"
+            } else if (log_texto) {
+                fputs(mensagem.texto, stdout);
+            }
+        }
+        trace_block_t bloco;
+        while (queue_try_remove(&fila_rastro, &bloco)) {
+            enviar_rastro(&bloco);
+        }
+        ler_comandos_serial();
+        recorder_task();
 
-    // Coluna 1: Tempo e Distância
-    ssd1306_draw_string(&ssd, "Tempo", 2, 20); // Alinhado à esquerda, sem margem
-    snprintf(buffer, sizeof(buffer), "%d s", calcular_tempo_decorrido()); // Exibe o tempo decorrido
-    ssd1306_draw_string(&ssd, buffer, 2, 30); // Alinhado à esquerda, sem margem
+        // Rodízio: cada volta começa por uma esteira diferente, para que
+        // nenhuma fique sempre por último
+        for (uint k = 0; k < NUM_ESTEIRAS; k++) {
+            atender_display(&esteiras[(primeira + k) % NUM_ESTEIRAS]);
+        }
+        primeira = (primeira + 1) % NUM_ESTEIRAS;
 
-    // Linha horizontal entre "X" e "Dist."
-    ssd1306_line(&ssd, 0, 38, 128, 38, true); // Linha horizontal cortando as duas colunas
+        // O núcleo 0 espera todos os displays desligados para reduzir o clock
+        bool dormindo = true;
+        for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+            dormindo &= esteiras[i].energia_aplicada == ENERGIA_DORMINDO;
+        }
+        if (dormindo != display_dormindo) {
+            display_dormindo = dormindo;
+            __sev();
+        }
 
-    ssd1306_draw_string(&ssd, "Dist.", 2, 40); // Alinhado à esquerda, sem margem
-    snprintf(buffer, sizeof(buffer), "%.1f m", distancia_percorrida);
-    ssd1306_draw_string(&ssd, buffer, 2, 50); // Alinhado à esquerda, sem margem
+        // Uma rolagem do gráfico em andamento acorda o núcleo no fim dela
+        bool rolando = false;
+        absolute_time_t prazo = at_the_end_of_time;
+        for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+            const grafico_t *g = &esteiras[i].grafico;
+            if (g->rolando && absolute_time_diff_us(g->fim_rolagem, prazo) > 0) {
+                prazo = g->fim_rolagem;
+                rolando = true;
+            }
+        }
+        if (rolando) {
+            best_effort_wfe_or_timeout(prazo);
+        } else {
+            __wfe();
+        }
+    }
+}
 
-    // Coluna 2: Incl. Média e Vel. Média
-    ssd1306_draw_string(&ssd, "Incl. M.", 57, 20); // Alinhado à esquerda, sem margem
-    snprintf(buffer, sizeof(buffer), "%.1f%%", inclinacao_media);
-    ssd1306_draw_string(&ssd, buffer, 57, 30); // Alinhado à esquerda, sem margem
+// Trata um evento de botão já filtrado pelo debounce
+void tratar_evento_botao(esteira_t *e, uint8_t botao, input_event_type_t tipo) {
+    if (!e->em_andamento) {
+        // Botão do joystick pressionado por 1 segundo inicia o treino
+        if (botao == ID_JOYSTICK && tipo == INPUT_LONG_PRESS) {
+            iniciar_treino(e);
+        }
+        return;
+    }
 
-    // Linha horizontal entre o valor da inclinação média e "Vel. M."
-    ssd1306_line(&ssd, 0, 38, 128, 38, true); // Linha horizontal cortando as duas colunas
+    if (tipo != INPUT_PRESS) {
+        return;
+    }
 
-    ssd1306_draw_string(&ssd, "Vel. M.", 57, 40); // Alinhado à esquerda, sem margem
-    snprintf(buffer, sizeof(buffer), "%.1f km/h", velocidade_media);
-    ssd1306_draw_string(&ssd, buffer, 57, 50); // Alinhado à esquerda, sem margem
+    switch (botao) {
+        case ID_BOTAO_A: // Finaliza o treino
+            finalizar_treino(e);
+            break;
+        case ID_JOYSTICK: // Pausa ou retoma o treino
+            if (e->pausado) {
+                iniciar_treino(e);
+            } else {
+                pausar_treino(e);
+            }
+            break;
+        case ID_BOTAO_B: // Ativa/desativa o alerta de emergência
+            pedir_ajuda_emergencia(e);
+            break;
+    }
+}
 
-    ssd1306_send_data(&ssd);
+void mudar_energia(energia_t energia) {
+    energia_display = energia;
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        publicar_estado(&esteiras[i]);
+    }
 }
 
-int main() {
-    stdio_init_all();
-    adc_init();
+// A UART da stdio é cronometrada por clk_peri, que acompanha o clk_sys
+void ajustar_perifericos_ao_clock() {
+#if LIB_PICO_STDIO_UART
+    uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+#endif
+}
 
-    // Inicialização do display OLED
-    i2c_init(I2C_PORT, 400 * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
+// Dormindo nenhuma tarefa roda para alimentar o watchdog: ele é desligado
+// junto com elas
+void ligar_watchdog(bool ligar) {
+    if (ligar) {
+        watchdog_enable(WATCHDOG_TIMEOUT_MS, true);
+    } else {
+        watchdog_disable();
+    }
+    scheduler_set_enabled(TAREFA_WATCHDOG, ligar);
+}
 
-    ssd1306_init(&ssd, 128, 64, false, OLED_ADDRESS, I2C_PORT);
-    ssd1306_config(&ssd);
-    ssd1306_fill(&ssd, false);
-    ssd1306_send_data(&ssd);
+// Desliga os displays e a captura do ADC, reduz o clock e tira todas as
+// tarefas do escalonador: o núcleo 0 fica em __wfe() até a IRQ de GPIO de um botão
+void dormir() {
+    bordas_ao_dormir = input_edge_count(); // Uma borda a partir daqui já acorda
+    registrar(NULL, "Repouso: display desligado e clock reduzido\n");
+    mudar_energia(ENERGIA_DORMINDO);
+
+    // O núcleo 1 desliga os displays antes que o clock do I2C mude
+    absolute_time_t prazo = make_timeout_time_ms(ESPERA_DISPLAY_DORMIR_MS);
+    while (!display_dormindo && !time_reached(prazo)) {
+        best_effort_wfe_or_timeout(prazo);
+    }
 
-    configure_pwm(LED_AZUL);
+    // Sem leitor, a captura contínua só acordaria o núcleo com a IRQ da DMA
+    if (adc_continuo) {
+        adc_stream_stop();
+    }
+    clock_normal_khz = clock_get_hz(clk_sys) / 1000;
+    set_sys_clock_48mhz(); // clk_sys passa para a PLL da USB; a PLL do sistema desliga
+    ajustar_perifericos_ao_clock();
+    scheduler_set_enabled(TAREFA_ENTRADA, false);
+    ligar_watchdog(false);
+}
 
-    // Configuração do botão B para emergência
-    gpio_init(BOTAO_B);
-    gpio_set_dir(BOTAO_B, GPIO_IN);
-    gpio_pull_up(BOTAO_B);
+// Restaura o clock e pede os displays de volta; a latência desde a borda é
+// medida aqui (clock) e no núcleo 1 (display religado, sonda "wake")
+void despertar() {
+    borda_despertar_us = input_last_edge_us();
+    set_sys_clock_khz(clock_normal_khz, true);
+    ajustar_perifericos_ao_clock();
+    latencia_clock_us = time_us_32() - borda_despertar_us;
+    if (adc_continuo) {
+        adc_stream_restart();
+    }
+    instante_us = time_us_64(); // Fora dos passos: só a telemetria usa este instante
 
-    // Configuração do LED vermelho
-    gpio_init(LED_VERMELHO);
-    gpio_set_dir(LED_VERMELHO, GPIO_OUT);
-    gpio_put(LED_VERMELHO, 0);
+    ultima_atividade = get_absolute_time();
+    scheduler_set_enabled(TAREFA_ENTRADA, true);
+    ligar_watchdog(true);
+    mudar_energia(ENERGIA_ATIVO);
+}
 
-    // Configura os pinos do joystick, buzzer e botão A
-    adc_gpio_init(JOYSTICK_X);
-    adc_gpio_init(JOYSTICK_Y);
+// Esteira sem treino, sem finalização pendente e sem emergência
+bool esteira_ociosa(const esteira_t *e) {
+    return !e->em_andamento && e->etapa_finalizacao == FINALIZACAO_NENHUMA && !e->emergencia_ativa;
+}
 
-    gpio_init(JOYSTICK_BUTTON);
-    gpio_set_dir(JOYSTICK_BUTTON, GPIO_IN);
-    gpio_pull_up(JOYSTICK_BUTTON);
+// Escurece e depois adormece o aparelho quando todas as esteiras estão paradas
+void gerenciar_energia() {
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        if (!esteira_ociosa(&esteiras[i])) {
+            ultima_atividade = get_absolute_time();
+            return;
+        }
+    }
 
-    gpio_init(BUZZER);
-    gpio_set_dir(BUZZER, GPIO_OUT);
-    gpio_put(BUZZER, 0);
+    int64_t parado_ms = absolute_time_diff_us(ultima_atividade, get_absolute_time()) / 1000;
+    if (parado_ms >= OCIOSO_DORMIR_MS) {
+        dormir();
+    } else if (parado_ms >= OCIOSO_ESCURECER_MS && energia_display == ENERGIA_ATIVO) {
+        mudar_energia(ENERGIA_ESCURO);
+    }
+}
 
-    gpio_init(BOTAO_A);
-    gpio_set_dir(BOTAO_A, GPIO_IN);
-    gpio_pull_up(BOTAO_A);
+// Esteira com treino rodando (nem parada, nem pausada)
+bool HOT_FUNC(esteira_correndo)(const esteira_t *e) {
+    return e->em_andamento && !e->pausado;
+}
 
-    velocidade_atual = 0.0;
-    tempo_anterior = get_absolute_time();
+// Começa o rastro com a configuração que a reprodução precisa repetir
+void iniciar_captura() {
+    trace_writer_init(&escritor_rastro);
+    blocos_rastro = 0;
+    blocos_rastro_perdidos = 0;
+    capturando = true;
+    gravar_rastro(TRACE_CONFIG, CONFIG_RASTRO_MINUTOS, tempo_treino_minutos);
+    gravar_rastro(TRACE_CONFIG, CONFIG_RASTRO_ESTEIRAS, NUM_ESTEIRAS);
+    registrar(NULL, "Rastro: captura iniciada\n");
+}
 
-    while (true) {
-        if (!treino_em_andamento) {
-            // Espera o botão do joystick ser pressionado por 1 segundo para iniciar o treino
-            if (!gpio_get(JOYSTICK_BUTTON)) {
-                uint32_t tempo_inicio = to_ms_since_boot(get_absolute_time());
-                while (!gpio_get(JOYSTICK_BUTTON) && to_ms_since_boot(get_absolute_time()) - tempo_inicio < 1000) {
-                    // Aguarda 1 segundo pressionado
-                }
-                if (!gpio_get(JOYSTICK_BUTTON)) {
-                    iniciar_treino();
-                }
-            }
+void encerrar_captura() {
+    trace_block_t cheio;
+    if (trace_flush(&escritor_rastro, &cheio)) {
+        if (queue_try_add(&fila_rastro, &cheio)) {
+            blocos_rastro++;
         } else {
-            atualizar_led_azul();
-            // Verifica o botão A para finalizar o treino
-            if (!gpio_get(BOTAO_A)) {
-                uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
-                if (tempo_atual - tempo_ultimo_clique_botao_A > 200) { // Debouncing de 200ms
-                    finalizar_treino();
-                    tempo_ultimo_clique_botao_A = tempo_atual;
-                }
-            }
+            blocos_rastro_perdidos++;
+        }
+    }
+    capturando = false;
+    registrar(NULL, "Rastro: captura encerrada, %lu blocos (%lu perdidos)\n", (unsigned long)blocos_rastro,
+              (unsigned long)blocos_rastro_perdidos);
+}
 
-            // Verifica o botão do joystick para pausar ou retomar o treino
-            if (!gpio_get(JOYSTICK_BUTTON)) {
-                uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
-                if (tempo_atual - tempo_ultimo_clique_botao_A > 200) { // Debouncing de 200ms
-                    if (treino_pausado) {
-                        iniciar_treino();
-                    } else {
-                        pausar_treino();
-                    }
-                    tempo_ultimo_clique_botao_A = tempo_atual;
-                }
-            }
+// Atende os comandos "rastro" vindos do núcleo 1. A reprodução parte de
+// esteiras paradas, então a captura também só começa com todas paradas.
+void atender_pedido_rastro() {
+    int pedido = pedido_rastro;
+    if (pedido == RASTRO_NENHUM) {
+        return;
+    }
+    pedido_rastro = RASTRO_NENHUM;
 
-            // Verifica o botão B para ativar/desativar o alerta de emergência
-            if (!gpio_get(BOTAO_B)) {
-                uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
-                if (tempo_atual - tempo_ultimo_clique_botao_A > 200) { // Debouncing de 200ms
-                    pedir_ajuda_emergencia();
-                    tempo_ultimo_clique_botao_A = tempo_atual;
-                }
+    if (pedido == RASTRO_INICIAR && !capturando) {
+        for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+            if (!esteira_ociosa(&esteiras[i])) {
+                registrar(NULL, "Rastro: só começa com as esteiras paradas\n");
+                return;
             }
         }
+        iniciar_captura();
+    } else if (pedido == RASTRO_PARAR && capturando) {
+        encerrar_captura();
+    }
+}
+
+// Próximo evento de botão: da fila da interrupção ou, na reprodução, do rastro
+bool proximo_evento_botao(input_event_t *evento) {
+    if (!reproduzindo) {
+        if (!input_poll(evento)) {
+            return false;
+        }
+        gravar_entrada(TRACE_BUTTON, evento->button, evento->type);
+        return true;
+    }
+
+    trace_event_t gravado;
+    if (!trace_peek(&leitor_rastro, &gravado) || gravado.kind != TRACE_BUTTON) {
+        return false;
+    }
+    trace_next(&leitor_rastro);
+    if (gravado.channel >= NUM_ESTEIRAS * BOTOES_POR_ESTEIRA) {
+        rastro_inconsistente = true;
+        return false;
+    }
+    evento->button = gravado.channel;
+    evento->type = (uint8_t)gravado.value;
+    evento->time_ms = (uint32_t)(gravado.time_us / 1000);
+    return true;
+}
+
+// Grava o estado dos treinos na cópia mais antiga do checkpoint. A cópia
+// fica inválida (sequencia = 0) durante a gravação e volta a valer com a
+// sequência nova nas duas pontas.
+void HOT_FUNC(salvar_retomada)() {
+    if (reproduzindo) {
+        return; // Um treino reproduzido não é retomado
+    }
+    if (++sequencia_retomada == 0) {
+        sequencia_retomada = 1;
+    }
+    retomada_t *r = &retomadas[sequencia_retomada % 2];
+    r->sequencia = 0;
+    __compiler_memory_barrier();
+    r->magica = RETOMADA_MAGICA;
+    r->instante_us = instante_us;
+    r->tempo_treino_minutos = tempo_treino_minutos;
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        const esteira_t *e = &esteiras[i];
+        retomada_esteira_t *c = &r->esteiras[i];
+        c->treino = e->treino;
+        c->em_andamento = e->em_andamento;
+        c->pausado = e->pausado;
+        c->emergencia_ativa = e->emergencia_ativa;
+        c->etapa_finalizacao = e->etapa_finalizacao;
+        c->tick_controle = e->tick_controle;
+        c->tela = e->telemetria_publicada.tela;
+        c->inicio_treino_us = to_us_since_boot(e->tempo_inicio_treino);
+        c->pausa_inicio_us = to_us_since_boot(e->tempo_pausa_inicio);
+        c->prazo_finalizacao_us = to_us_since_boot(e->prazo_finalizacao);
+    }
+    r->sequencia_fim = sequencia_retomada;
+    __compiler_memory_barrier();
+    r->sequencia = sequencia_retomada;
+}
 
-        if (treino_em_andamento && !treino_pausado) {
-            adc_select_input(0);
-            uint16_t valor_x = adc_read(); // Leitura do eixo X (velocidade)
+// Tarefas do núcleo 0: cada ativação atende todas as esteiras, de modo que
+// todas recebem o mesmo serviço no mesmo período. Na reprodução elas são
+// chamadas pelo rastro, sem o repouso (a energia não afeta o treino).
 
-            adc_select_input(1);
-            uint16_t valor_y = adc_read(); // Leitura do eixo Y (inclinação)
+// Trata os eventos de botão acumulados pela interrupção
+void tarefa_entrada() {
+    comecar_passo(TAREFA_ENTRADA, false);
+    if (!reproduzindo) {
+        atender_pedido_rastro();
+    }
 
-            // Atualiza a inclinação apenas se o joystick for movido para cima ou para baixo
-            if (valor_y > 3000 && indice_inclinacao < 4) {
-                indice_inclinacao++;
-            } else if (valor_y < 1000 && indice_inclinacao > 0) {
-                indice_inclinacao--;
+    input_event_t evento;
+    while (proximo_evento_botao(&evento)) {
+        if (!reproduzindo) {
+            ultima_atividade = get_absolute_time();
+            if (energia_display == ENERGIA_ESCURO) {
+                mudar_energia(ENERGIA_ATIVO);
             }
-            inclinacao_atual = inclinacao_niveis[indice_inclinacao];
+        }
+        tratar_evento_botao(&esteiras[evento.button / BOTOES_POR_ESTEIRA], evento.button % BOTOES_POR_ESTEIRA,
+                            evento.type);
+    }
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        processar_finalizacao(&esteiras[i]);
+    }
+    salvar_retomada();
+    if (!reproduzindo) {
+        gerenciar_energia();
+    }
+}
 
-            // Atualiza a velocidade apenas se o joystick for movido para os lados
-            if (valor_x > 3000 && velocidade_atual < velocidade_max) {
-                velocidade_atual += 0.5;
-            } else if (valor_x < 1000 && velocidade_atual > 0.0) {
-                velocidade_atual -= 0.5;
+void HOT_FUNC(tarefa_fisica)() {
+    comecar_passo(TAREFA_FISICA, true);
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        esteira_t *e = &esteiras[i];
+        if (esteira_correndo(e)) {
+            integrar_treino(e);
+            verificar_fim_do_tempo(e);
+        }
+    }
+    salvar_retomada();
+}
+
+// Um passo da rampa de velocidade e inclinação e uma amostra para o gravador
+void HOT_FUNC(tarefa_rampa)() {
+    comecar_passo(TAREFA_RAMPA, true);
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        esteira_t *e = &esteiras[i];
+        if (!esteira_correndo(e)) {
+            continue;
+        }
+        uint32_t sonda = probe_start();
+
+        uint16_t valor_x = ler_eixo_joystick(e->config->joystick_x); // Leitura do eixo X (velocidade)
+        uint16_t valor_y = ler_eixo_joystick(e->config->joystick_y); // Leitura do eixo Y (inclinação)
+
+        // O intervalo até aqui vale com a velocidade antiga
+        integrar_treino(e);
+        treino_ajustar(&e->treino, valor_x, valor_y);
+        gravar_registro(e, RECORDER_SAMPLE);
+        e->tick_controle++;
+        probe_record(PROBE_TICK, sonda);
+    }
+    salvar_retomada();
+}
+
+// O núcleo 1 imprime a linha do tick e atualiza o display
+void HOT_FUNC(tarefa_display)() {
+    comecar_passo(TAREFA_DISPLAY, false);
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        if (esteira_correndo(&esteiras[i])) {
+            publicar_telemetria(&esteiras[i], TELA_TREINO);
+        }
+    }
+}
+
+void tarefa_led() {
+    comecar_passo(TAREFA_LED, false);
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        if (esteiras[i].em_andamento) {
+            atualizar_led_azul(&esteiras[i]);
+        }
+    }
+}
+
+// Alimenta o watchdog se o núcleo 1 deu alguma volta desde a última
+// ativação; o __sev() garante que ele dê pelo menos uma por período. Um
+// núcleo 1 preso ou um núcleo 0 que não chega mais aqui deixam o watchdog
+// vencer.
+void tarefa_watchdog() {
+    uint32_t voltas = voltas_nucleo1;
+    if (voltas != voltas_vistas) {
+        voltas_vistas = voltas;
+        watchdog_update();
+    }
+    __sev();
+}
+
+static const scheduler_task_config_t tarefas[] = {
+    [TAREFA_ENTRADA] = { "entrada", PERIODO_ENTRADA_US, tarefa_entrada, true },
+    [TAREFA_FISICA]  = { "fisica", PERIODO_FISICA_US, tarefa_fisica, false },
+    [TAREFA_RAMPA]   = { "rampa", PERIODO_RAMPA_US, tarefa_rampa, false },
+    [TAREFA_DISPLAY] = { "display", PERIODO_DISPLAY_US, tarefa_display, false },
+    [TAREFA_LED]     = { "led", PERIODO_LED_US, tarefa_led, false },
+    [TAREFA_WATCHDOG] = { "watchdog", PERIODO_WATCHDOG_US, tarefa_watchdog, false },
+};
+
+// Liga só as tarefas que o estado dos treinos pede
+void atualizar_tarefas() {
+    bool correndo = false;
+    bool em_andamento = false;
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        correndo |= esteira_correndo(&esteiras[i]);
+        em_andamento |= esteiras[i].em_andamento;
+    }
+    scheduler_set_enabled(TAREFA_FISICA, correndo);
+    scheduler_set_enabled(TAREFA_RAMPA, correndo);
+    scheduler_set_enabled(TAREFA_DISPLAY, correndo);
+    scheduler_set_enabled(TAREFA_LED, em_andamento);
+}
+
+// Configuração gravada no início do rastro
+void aplicar_config_rastro(const trace_event_t *evento) {
+    if (evento->channel == CONFIG_RASTRO_MINUTOS && evento->value > 0) {
+        tempo_treino_minutos = evento->value;
+    } else if (evento->channel == CONFIG_RASTRO_ESTEIRAS && evento->value != NUM_ESTEIRAS) {
+        registrar(NULL, "Rastro: capturado com %ld esteiras\n", (long)evento->value);
+        rastro_inconsistente = true;
+    }
+}
+
+// Ao fim da reprodução o controle volta ao relógio real: treinos deixados
+// pela metade são descartados, os resultados ficam nas telas
+void encerrar_reproducao() {
+    reproduzindo = false;
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        esteira_t *e = &esteiras[i];
+        pattern_stop(e->canal_buzzer);
+        pattern_stop(e->canal_led_vermelho);
+        e->em_andamento = false;
+        e->pausado = false;
+        e->emergencia_ativa = false;
+        e->etapa_finalizacao = FINALIZACAO_NENHUMA;
+        publicar_estado(e);
+    }
+    atualizar_tarefas();
+}
+
+// Reprodução: no lugar do escalonador, roda cada passo do rastro no instante
+// gravado, com as leituras do joystick e os botões vindos do rastro. Em
+// tempo real, espera o intervalo original entre os passos; senão, roda o
+// próximo assim que o anterior termina.
+void reproduzir_rastro() {
+    trace_reader_init(&leitor_rastro, rastro_reproduzir, tamanho_rastro_reproduzir);
+    reproduzindo = true;
+    registrar(NULL, "Rastro: reprodução %s\n", rastro_tempo_real ? "em tempo real" : "acelerada");
+
+    uint32_t passos = 0;
+    uint64_t primeiro_us = 0;
+    uint64_t inicio_us = time_us_64();
+    trace_event_t evento;
+    while (!rastro_inconsistente && trace_peek(&leitor_rastro, &evento)) {
+        trace_next(&leitor_rastro);
+        if (evento.kind == TRACE_CONFIG) {
+            aplicar_config_rastro(&evento);
+            continue;
+        }
+        if (evento.kind != TRACE_STEP || evento.channel >= sizeof(tarefas) / sizeof(tarefas[0])) {
+            rastro_inconsistente = true; // Entrada que o passo anterior não consumiu
+            break;
+        }
+        if (passos++ == 0) {
+            primeiro_us = evento.time_us;
+        }
+        if (rastro_tempo_real) {
+            absolute_time_t alvo = from_us_since_boot(inicio_us + (evento.time_us - primeiro_us));
+            while (!time_reached(alvo)) {
+                best_effort_wfe_or_timeout(alvo);
             }
+        }
+        instante_us = evento.time_us;
+        tarefas[evento.channel].run();
+    }
 
-            // Atualiza as somas para cálculo da média
-            soma_velocidade += velocidade_atual;
-            soma_inclinacao += inclinacao_atual;
-            contador_medidas++;
+    uint64_t duracao_us = time_us_64() - inicio_us;
+    if (rastro_inconsistente || leitor_rastro.broken) {
+        registrar(NULL, "Rastro: interrompido no passo %lu (bloco perdido ou entrada fora de ordem)\n",
+                  (unsigned long)passos);
+    }
+    registrar(NULL, "Rastro: %lu passos em %lu blocos, %lu ms de treino reproduzidos em %lu ms\n",
+              (unsigned long)passos, (unsigned long)leitor_rastro.blocks,
+              (unsigned long)((instante_us - primeiro_us) / 1000), (unsigned long)(duracao_us / 1000));
+    encerrar_reproducao();
+}
+
+// Checkpoint mais novo entre as duas cópias inteiras, ou NULL
+const retomada_t *retomada_valida() {
+    const retomada_t *valida = NULL;
+    for (uint i = 0; i < 2; i++) {
+        const retomada_t *r = &retomadas[i];
+        if (r->magica == RETOMADA_MAGICA && r->sequencia != 0 && r->sequencia == r->sequencia_fim &&
+            (valida == NULL || (int32_t)(r->sequencia - valida->sequencia) > 0)) {
+            valida = r;
+        }
+    }
+    return valida;
+}
+
+// Depois de um reinício pelo watchdog, volta ao estado do último checkpoint
+// sem beeps nem mensagens de início. O tempo parado no reinício fica de
+// fora, como numa pausa: os instantes guardados são deslocados para o
+// relógio do boot novo (o início do treino fica antes do boot, e as
+// diferenças de tempo continuam certas). Um treino em andamento abre uma
+// sessão nova no gravador: os registros que ainda estavam na RAM dele se
+// perderam no reinício. Em qualquer outro boot o checkpoint é descartado.
+bool retomar_treinos() {
+    const retomada_t *r = NULL;
+    if (rastro_reproduzir == NULL && watchdog_enable_caused_reboot()) {
+        r = retomada_valida();
+    }
+    if (r == NULL) {
+        retomadas[0].magica = 0;
+        retomadas[1].magica = 0;
+        return false;
+    }
+
+    instante_us = time_us_64();
+    uint64_t deslocamento_us = instante_us - r->instante_us; // Modular: o relógio recomeçou do zero
+    tempo_treino_minutos = r->tempo_treino_minutos;
+    sequencia_retomada = r->sequencia;
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        esteira_t *e = &esteiras[i];
+        const retomada_esteira_t *c = &r->esteiras[i];
+        e->treino = c->treino;
+        e->treino.ultimo_us += deslocamento_us;
+        e->em_andamento = c->em_andamento;
+        e->pausado = c->pausado;
+        e->emergencia_ativa = c->emergencia_ativa;
+        e->etapa_finalizacao = c->etapa_finalizacao;
+        e->tick_controle = c->tick_controle;
+        e->tempo_inicio_treino = from_us_since_boot(c->inicio_treino_us + deslocamento_us);
+        e->tempo_pausa_inicio = from_us_since_boot(c->pausa_inicio_us + deslocamento_us);
+        e->prazo_finalizacao = from_us_since_boot(c->prazo_finalizacao_us + deslocamento_us);
+
+        if (e->emergencia_ativa) {
+            pattern_play(e->canal_buzzer, &alerta_emergencia);
+            pattern_play(e->canal_led_vermelho, &alerta_emergencia);
+        }
+        if (e->em_andamento) {
+            atualizar_led_azul(e);
+            gravar_registro(e, RECORDER_START);
+            registrar(e, "Treino retomado: %u.%u m em %d s\n",
+                      TREINO_DECIMOS(TREINO_DECIMOS_METRO(treino_distancia_mm(&e->treino))),
+                      calcular_tempo_decorrido(e));
+        } else if (e->etapa_finalizacao != FINALIZACAO_NENHUMA) {
+            set_brightness(e->config->led_azul, 100);
+        }
+        publicar_telemetria(e, c->tela);
+    }
+    registrar(NULL, "Reinício pelo watchdog: estado retomado %lu us após o boot\n", (unsigned long)time_us_32());
+    return true;
+}
+
+// Pinos, padrões e treino de uma esteira (núcleo 0)
+void iniciar_esteira(esteira_t *e, uint indice, input_button_config_t *botoes) {
+    const esteira_config_t *c = &config_esteiras[indice];
+    e->config = c;
+    e->indice = (uint8_t)indice;
 
-            // Calcula a distância percorrida
-            absolute_time_t tempo_atual = get_absolute_time();
-            int64_t tempo_decorrido_ms = absolute_time_diff_us(tempo_anterior, tempo_atual) / 1000;
-            tempo_anterior = tempo_atual;
+    configure_pwm(c->led_azul);
 
-            distancia_percorrida += (velocidade_atual * 1000 / 3600) * (tempo_decorrido_ms / 1000.0);
+    // LED vermelho (digital) e buzzer (PWM) tocados pelo reprodutor de padrões
+    e->canal_led_vermelho = pattern_channel_init(c->led_vermelho, false);
+    e->canal_buzzer = pattern_channel_init(c->buzzer, true);
 
-            printf("Velocidade: %.1f km/h | Inclinação: %.1f%% | Distância: %.1f m\n",
-                   velocidade_atual, inclinacao_atual, distancia_percorrida);
+    // Configura os pinos do joystick (entrada ADC n = GPIO 26 + n)
+    adc_gpio_init(26 + c->joystick_x);
+    config_joystick.input_mask |= 1u << c->joystick_x;
+    if (c->joystick_y != SEM_EIXO) {
+        adc_gpio_init(26 + c->joystick_y);
+        config_joystick.input_mask |= 1u << c->joystick_y;
+    }
+
+    // Segurar o botão do joystick por 1 s inicia o treino
+    botoes[ID_JOYSTICK] = (input_button_config_t){ c->botao_joystick, 20, 1000, 0 };
+    botoes[ID_BOTAO_A] = (input_button_config_t){ c->botao_a, 20, 0, 0 };
+    botoes[ID_BOTAO_B] = (input_button_config_t){ c->botao_b, 20, 0, 0 };
+
+    treino_reiniciar(&e->treino, time_us_64());
+}
 
-            // Atualiza o display com as informações do treino
-            atualizar_display_treino();
+int main() {
+    boot_profile_mark(BOOT_RUNTIME);
+    stdio_init_all();
+    boot_profile_mark(BOOT_STDIO);
+    adc_init();
+    boot_profile_mark(BOOT_ADC);
 
-            sleep_ms(500);
+    input_button_config_t botoes[NUM_ESTEIRAS * BOTOES_POR_ESTEIRA];
+    for (uint i = 0; i < NUM_ESTEIRAS; i++) {
+        iniciar_esteira(&esteiras[i], i, &botoes[i * BOTOES_POR_ESTEIRA]);
+    }
+    boot_profile_mark(BOOT_GPIO);
+    adc_continuo = adc_stream_init(&config_joystick);
+    boot_profile_mark(BOOT_ADC);
+
+    // Displays e stdio passam para o núcleo 1
+    queue_init(&fila_mensagens, sizeof(mensagem_t), TAMANHO_FILA_MENSAGENS);
+    queue_init(&fila_rastro, sizeof(trace_block_t), TAMANHO_FILA_RASTRO);
+#if RASTRO_EMBUTIDO
+    rastro_reproduzir = rastro_embutido;
+    tamanho_rastro_reproduzir = tamanho_rastro_embutido;
+#endif
+    if (rastro_reproduzir != NULL) {
+        log_texto = true; // O resultado da reprodução é o log
+    }
+    // O gravador da flash também fica no núcleo 1, que segura este núcleo
+    // durante as gravações (flash_safe_execute)
+    recorder_init();
+    flash_safe_execute_core_init();
+    boot_profile_mark(BOOT_RECORDER);
+    multicore_launch_core1(nucleo1_main);
+    boot_profile_mark(BOOT_CORE1_LAUNCH);
+
+    // Botões de todas as esteiras por interrupção, com debounce independente
+    input_init(botoes, NUM_ESTEIRAS * BOTOES_POR_ESTEIRA);
+    boot_profile_mark(BOOT_GPIO);
+
+    // Depois de um reinício pelo watchdog, os treinos continuam de onde
+    // estavam; um rastro só começa com as esteiras paradas
+    bool retomado = retomar_treinos();
+    boot_profile_mark(BOOT_RESUME);
+    if (rastro_reproduzir != NULL) {
+        reproduzir_rastro();
+        boot_profile_begin(); // A reprodução não é boot
+    } else if (RASTRO_PADRAO && !retomado) {
+        instante_us = time_us_64();
+        iniciar_captura();
+    }
+
+    ultima_atividade = get_absolute_time();
+    scheduler_init(tarefas, sizeof(tarefas) / sizeof(tarefas[0]));
+    atualizar_tarefas(); // As dos treinos retomados
+    ligar_watchdog(true);
+    boot_profile_mark(BOOT_CONTROL);
+    if (BOOT_PROFILE_ENABLED) {
+        // As fases do núcleo 1 já estão marcadas quando ele chega à fila
+        mensagem_t fim = { .fim_do_boot = true };
+        while (!queue_try_add(&fila_mensagens, &fim)) {
+            best_effort_wfe_or_timeout(make_timeout_time_us(1000));
+        }
+        __sev();
+    }
+    while (true) {
+        scheduler_run_once();
+        // Dormindo não há tarefas: a IRQ de uma borda de botão acorda o núcleo
+        if (energia_display == ENERGIA_DORMINDO && input_edge_count() != bordas_ao_dormir) {
+            despertar();
         }
     }
 
     return 0;
-}
\ No newline at end of file
+}